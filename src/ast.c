@@ -2,9 +2,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include "ast.h"
+#include "generic.h"
+#include "symbol.h"
 
 // frees ast
+// nodes shared by function values are only released, and freed by their last holder
 void AstNode_free(AstNode *p_head) {
+  if (__atomic_sub_fetch(&p_head->refCount, 1, __ATOMIC_ACQ_REL) > 0) return;
+
   // for each child, free memory
   AstNode *p_curr = p_head->p_headChild;
   AstNode *p_tmp = NULL;
@@ -16,7 +21,9 @@ void AstNode_free(AstNode *p_head) {
   }
 
   // free self
-  free(p_head->val);
+  if (p_head->p_constant != NULL) Generic_free(p_head->p_constant);
+  if (p_head->p_inlined != NULL) AstNode_free(p_head->p_inlined);
+  if (p_head->opcode != OP_IDENTIFIER) free(p_head->val);
   free(p_head);
 }
 
@@ -40,7 +47,11 @@ char* getOpcodeString(enum Opcodes code) {
 void AstNode_print(AstNode *p_head, int depth) {
 
   // print current node
-  if (p_head->val == NULL) printf("%i| %s\n", p_head->lineNumber, getOpcodeString(p_head->opcode));
+  if (p_head->p_constant != NULL) {
+    printf("%i| %s (folded): ", p_head->lineNumber, getOpcodeString(p_head->opcode));
+    Generic_print(p_head->p_constant);
+    printf("\n");
+  } else if (p_head->val == NULL) printf("%i| %s\n", p_head->lineNumber, getOpcodeString(p_head->opcode));
   else printf("%i| %s: %s\n", p_head->lineNumber, getOpcodeString(p_head->opcode), p_head->val);
 
   // for each child
@@ -55,6 +66,13 @@ void AstNode_print(AstNode *p_head, int depth) {
 
     p_curr = p_curr->p_next;
   }
+
+  // print the inlined body of an application after its children
+  if (p_head->p_inlined != NULL) {
+    for (int x = 0; x < depth + 1; x++) printf("   ");
+    printf("(inlined) ");
+    AstNode_print(p_head->p_inlined, depth + 1);
+  }
 }
 
 // appened an item as child to p_head, given a pointer to p_lastChild
@@ -76,13 +94,19 @@ AstNode* AstNode_new(char* val, enum Opcodes opcode, int lineNumber) {
   res->p_headChild = NULL;
   res->p_next = NULL;
   res->val = NULL;
+  res->fused = false;
+  res->p_constant = NULL;
+  res->inlineId = 0;
+  res->p_inlined = NULL;
+  res->refCount = 1;
 
-  if (val != NULL) {
+  if (val != NULL && opcode == OP_IDENTIFIER) {
+    res->val = Symbol_intern(val, strlen(val));
+  } else if (val != NULL) {
     res->val = (char *) malloc(sizeof(char) * (strlen(val) + 1));
     strcpy(res->val, val);
   }
 
-
   res->lineNumber = lineNumber;
   return res;
 }
@@ -91,11 +115,32 @@ AstNode* AstNode_new(char* val, enum Opcodes opcode, int lineNumber) {
 // depth is the current depth of the copy (start at 0), if 0, do not copy siblings
 AstNode* AstNode_copy(AstNode *p_head, int depth) {
   if (p_head == NULL) return NULL;
-  AstNode* p_res = AstNode_new(p_head->val, p_head->opcode, p_head->lineNumber);
+
+  // symbols are shared rather than interned again
+  AstNode* p_res = AstNode_new(p_head->opcode == OP_IDENTIFIER ? NULL : p_head->val, p_head->opcode, p_head->lineNumber);
+  if (p_head->opcode == OP_IDENTIFIER) p_res->val = p_head->val;
+  p_res->fused = p_head->fused;
+
+  // folded constants are held by the node
+  if (p_head->p_constant != NULL) {
+    p_res->p_constant = Generic_copy(p_head->p_constant);
+    p_res->p_constant->refCount++;
+  }
+
+  p_res->inlineId = p_head->inlineId;
+  p_res->p_inlined = AstNode_copy(p_head->p_inlined, 0);
+
   p_res->p_headChild = AstNode_copy(p_head->p_headChild, depth + 1);
   
   if (depth != 0) p_res->p_next = AstNode_copy(p_head->p_next, depth + 1);
   else p_res->p_next = NULL;
 
   return p_res;
-}
\ No newline at end of file
+}
+// shares p_head with a new holder (ie. a function value), rather than copying it, and returns it
+// the ast is never modified while it is evaluated, so holders on any thread can share it
+// p_next is left pointing into the tree holding the node, so it must not be followed from a shared node
+AstNode* AstNode_share(AstNode *p_head) {
+  __atomic_add_fetch(&p_head->refCount, 1, __ATOMIC_RELAXED);
+  return p_head;
+}
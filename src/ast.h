@@ -1,5 +1,7 @@
 #ifndef AST_H
 #define AST_H
+#include <stdbool.h>
+
 // types for ast nodes (opcodes)
 enum Opcodes {
   OP_INT,
@@ -17,13 +19,22 @@ enum Opcodes {
 // each node is an element in a linked list of it's siblings
 // additionally, each node contains a pointer to a "head" child node (may be null)
 // each node has an opCode to designate an opperation when the tree is traversed afterwards (string)
-// each node has a val (string)
+// each node has a val (string), which is an interned symbol for identifiers (see symbol.c), and owned by the node otherwise
+// fused is set by the fusion pass, on applications whose first argument can be evaluated lazily (see fuse.c)
+// p_constant is set by the folding pass, on applications of pure builtins to constants, and holds their result (see fold.c)
+// inlineId identifies functions which can be inlined, and p_inlined holds the callee's body on applications they were inlined into (see inline.c)
+// refCount is the number of holders of the node, its parent and any function values sharing it (see AstNode_share)
 typedef struct AstNode {
   struct AstNode *p_headChild;
   struct AstNode *p_next;
   enum Opcodes opcode;
   char *val;
   int lineNumber;
+  bool fused;
+  struct Generic *p_constant;
+  unsigned int inlineId;
+  struct AstNode *p_inlined;
+  int refCount;
 } AstNode;
 
 // prototypes
@@ -33,5 +44,6 @@ void AstNode_print(AstNode *, int);
 void AstNode_appendChild(AstNode *, AstNode **, AstNode *);
 AstNode* AstNode_new(char*, enum Opcodes, int);
 AstNode* AstNode_copy(AstNode *, int);
+AstNode* AstNode_share(AstNode *);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "channel.h"
+#include "generic.h"
+
+// channels are bounded multi producer, multi consumer queues (Vyukov's algorithm)
+// every cell has a sequence number, which is its index while it is free to send into,
+// and index + 1 once it holds a value that can be received
+// sendIndex and receiveIndex only ever grow, and are wrapped into cells with capacity - 1 as a mask
+
+// creates a new channel, able to hold at least capacity values
+Channel *Channel_new(int capacity) {
+  Channel *res = (Channel *) malloc(sizeof(Channel));
+  res->refCount = 1;
+
+  // round up to a power of 2, so indices can be masked
+  res->capacity = 1;
+  while (res->capacity < (size_t) capacity) res->capacity *= 2;
+
+  res->cells = (ChannelCell *) malloc(sizeof(ChannelCell) * res->capacity);
+  for (size_t i = 0; i < res->capacity; i++) {
+    res->cells[i].sequence = i;
+    res->cells[i].p_val = NULL;
+  }
+
+  res->sendIndex = 0;
+  res->receiveIndex = 0;
+  res->waiting = 0;
+  pthread_mutex_init(&res->lock, NULL);
+  pthread_cond_init(&res->changed, NULL);
+
+  return res;
+}
+
+// channels are shared between every generic (and thread) that holds them
+Channel *Channel_copy(Channel *p_target) {
+  __atomic_add_fetch(&p_target->refCount, 1, __ATOMIC_RELAXED);
+  return p_target;
+}
+
+// drops a reference to a channel, freeing it (and any values never received) once unreferenced
+void Channel_free(Channel *p_target) {
+  if (__atomic_sub_fetch(&p_target->refCount, 1, __ATOMIC_ACQ_REL) > 0) return;
+
+  // received cells are emptied, so any value left was never received
+  for (size_t i = 0; i < p_target->capacity; i++) {
+    if (p_target->cells[i].p_val != NULL) Generic_free(p_target->cells[i].p_val);
+  }
+
+  pthread_mutex_destroy(&p_target->lock);
+  pthread_cond_destroy(&p_target->changed);
+  free(p_target->cells);
+  free(p_target);
+}
+
+// attempts to send p_val, returns false if the channel is full
+bool trySend(Channel *p_target, Generic *p_val) {
+  size_t index = __atomic_load_n(&p_target->sendIndex, __ATOMIC_RELAXED);
+
+  while (true) {
+    ChannelCell *p_cell = &p_target->cells[index & (p_target->capacity - 1)];
+    size_t sequence = __atomic_load_n(&p_cell->sequence, __ATOMIC_ACQUIRE);
+    intptr_t diff = (intptr_t) sequence - (intptr_t) index;
+
+    if (diff == 0) {
+      // cell is free, claim it (on failure, index is updated to the current sendIndex)
+      if (__atomic_compare_exchange_n(&p_target->sendIndex, &index, index + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        p_cell->p_val = p_val;
+        __atomic_store_n(&p_cell->sequence, index + 1, __ATOMIC_RELEASE);
+        return true;
+      }
+    } else if (diff < 0) {
+      // cell still holds a value from the previous lap, so the channel is full
+      return false;
+    } else {
+      // another sender claimed the cell first
+      index = __atomic_load_n(&p_target->sendIndex, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+// attempts to receive a value, returns NULL if the channel is empty
+Generic *tryReceive(Channel *p_target) {
+  size_t index = __atomic_load_n(&p_target->receiveIndex, __ATOMIC_RELAXED);
+
+  while (true) {
+    ChannelCell *p_cell = &p_target->cells[index & (p_target->capacity - 1)];
+    size_t sequence = __atomic_load_n(&p_cell->sequence, __ATOMIC_ACQUIRE);
+    intptr_t diff = (intptr_t) sequence - (intptr_t) (index + 1);
+
+    if (diff == 0) {
+      // cell holds a value, claim it, and free the cell for the next lap
+      if (__atomic_compare_exchange_n(&p_target->receiveIndex, &index, index + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        Generic *res = p_cell->p_val;
+        p_cell->p_val = NULL;
+        __atomic_store_n(&p_cell->sequence, index + p_target->capacity, __ATOMIC_RELEASE);
+        return res;
+      }
+    } else if (diff < 0) {
+      // nothing sent into the cell yet, so the channel is empty
+      return NULL;
+    } else {
+      // another receiver claimed the cell first
+      index = __atomic_load_n(&p_target->receiveIndex, __ATOMIC_RELAXED);
+    }
+  }
+}
+
+// wakes every thread sleeping on the channel, after a value was sent or received
+// waiting is only incremented while holding lock, so a sleeper either sees the change, or is woken here
+void wakeWaiting(Channel *p_target) {
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&p_target->waiting, __ATOMIC_RELAXED) == 0) return;
+
+  pthread_mutex_lock(&p_target->lock);
+  pthread_cond_broadcast(&p_target->changed);
+  pthread_mutex_unlock(&p_target->lock);
+}
+
+// sends p_val into the channel, sleeping while it is full
+// the channel takes ownership of p_val, which should not be referenced by the sending thread
+void Channel_send(Channel *p_target, Generic *p_val) {
+  bool sent = trySend(p_target, p_val);
+
+  while (!sent) {
+    pthread_mutex_lock(&p_target->lock);
+    __atomic_add_fetch(&p_target->waiting, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    // check again, as a value may have been received before waiting was incremented
+    sent = trySend(p_target, p_val);
+    if (!sent) pthread_cond_wait(&p_target->changed, &p_target->lock);
+
+    __atomic_sub_fetch(&p_target->waiting, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&p_target->lock);
+  }
+
+  wakeWaiting(p_target);
+}
+
+// receives the oldest value in the channel, sleeping while it is empty
+// the caller takes ownership of the result
+Generic *Channel_receive(Channel *p_target) {
+  Generic *res = tryReceive(p_target);
+
+  while (res == NULL) {
+    pthread_mutex_lock(&p_target->lock);
+    __atomic_add_fetch(&p_target->waiting, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    // check again, as a value may have been sent before waiting was incremented
+    res = tryReceive(p_target);
+    if (res == NULL) pthread_cond_wait(&p_target->changed, &p_target->lock);
+
+    __atomic_sub_fetch(&p_target->waiting, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&p_target->lock);
+  }
+
+  wakeWaiting(p_target);
+  return res;
+}
@@ -0,0 +1,35 @@
+#ifndef CHANNEL_H
+#define CHANNEL_H
+#include <stddef.h>
+#include <pthread.h>
+#include "generic.h"
+
+// a single slot in a channel
+// sequence tells senders and receivers whose turn it is to use the slot (see channel.c)
+typedef struct ChannelCell {
+  size_t sequence;
+  Generic *p_val;
+} ChannelCell;
+
+// bounded queue of values, shared between threads
+// sending and receiving is lock free, lock and changed are only used to sleep while the channel is full or empty
+// capacity is always a power of 2
+typedef struct Channel {
+  int refCount;
+  size_t capacity;
+  ChannelCell *cells;
+  size_t sendIndex;
+  size_t receiveIndex;
+  int waiting;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+} Channel;
+
+// prototypes
+Channel *Channel_new(int);
+Channel *Channel_copy(Channel *);
+void Channel_free(Channel *);
+void Channel_send(Channel *, Generic *);
+Generic *Channel_receive(Channel *);
+
+#endif
@@ -0,0 +1,96 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "coroutine.h"
+#include "generic.h"
+
+// stackful coroutines, used by generators
+// every coroutine gets its own stack, which is only reserved, so memory is only used for the parts of it that are touched
+// the lowest page of the stack is a guard page, so that overflowing the stack crashes instead of corrupting memory
+
+// size of the stack reserved for each coroutine, as eval recurses deeply
+#define COROUTINE_STACK_SIZE (8 * 1024 * 1024)
+
+// coroutine running on this thread, NULL if not in a coroutine
+__thread Coroutine *currentCoroutine = NULL;
+
+// entry point of every coroutine, runs its body and switches back to the caller for the last time
+void coroutineMain() {
+  Coroutine *p_co = currentCoroutine;
+  p_co->body(p_co->p_data);
+
+  p_co->finished = true;
+  setcontext(&p_co->callerContext);
+}
+
+// creates a new coroutine, which will run body with p_data the first time it is resumed
+Coroutine *Coroutine_new(CoroutineBody body, void *p_data) {
+  Coroutine *res = (Coroutine *) malloc(sizeof(Coroutine));
+  res->p_caller = NULL;
+  res->finished = false;
+  res->body = body;
+  res->p_data = p_data;
+  res->p_yielded = NULL;
+
+  // reserve the stack, and protect its lowest page
+  long pageSize = sysconf(_SC_PAGESIZE);
+  res->stackSize = COROUTINE_STACK_SIZE;
+  res->stack = mmap(
+    NULL, res->stackSize, PROT_READ | PROT_WRITE,
+    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0
+  );
+
+  if (res->stack == MAP_FAILED) {
+    printf("Runtime Error: Could not allocate a stack for a generator.\n");
+    exit(0);
+  }
+
+  mprotect(res->stack, pageSize, PROT_NONE);
+
+  getcontext(&res->context);
+  res->context.uc_stack.ss_sp = (char *) res->stack + pageSize;
+  res->context.uc_stack.ss_size = res->stackSize - pageSize;
+  res->context.uc_link = NULL;
+  makecontext(&res->context, coroutineMain, 0);
+
+  return res;
+}
+
+// runs p_co until it yields or finishes
+// returns the value it yielded (which belongs to the caller), or NULL once it has finished
+Generic *Coroutine_resume(Coroutine *p_co) {
+  if (p_co->finished) return NULL;
+
+  p_co->p_caller = currentCoroutine;
+  currentCoroutine = p_co;
+  swapcontext(&p_co->callerContext, &p_co->context);
+  currentCoroutine = p_co->p_caller;
+
+  Generic *res = p_co->p_yielded;
+  p_co->p_yielded = NULL;
+  return res;
+}
+
+// suspends the current coroutine, passing p_val to whoever resumed it
+// returns once the coroutine is resumed again
+void Coroutine_yield(Generic *p_val) {
+  Coroutine *p_co = currentCoroutine;
+  p_co->p_yielded = p_val;
+  swapcontext(&p_co->context, &p_co->callerContext);
+}
+
+// returns the coroutine running on this thread, or NULL if there is none
+Coroutine *Coroutine_current() {
+  return currentCoroutine;
+}
+
+// frees a coroutine and its stack
+// if the coroutine has not finished, anything held by its suspended body is never freed
+void Coroutine_free(Coroutine *p_co) {
+  if (p_co->p_yielded != NULL) Generic_free(p_co->p_yielded);
+  munmap(p_co->stack, p_co->stackSize);
+  free(p_co);
+}
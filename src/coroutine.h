@@ -0,0 +1,33 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+#include <stdbool.h>
+#include <stddef.h>
+#include <ucontext.h>
+#include "generic.h"
+
+// function run by a coroutine
+typedef void (*CoroutineBody)(void *p_data);
+
+// a function running on its own stack, which can suspend itself (Coroutine_yield) and be resumed later
+// p_caller: the coroutine that resumed this one, NULL if it was resumed from outside any coroutine
+// p_yielded: the value passed to the last Coroutine_yield, until it is taken by Coroutine_resume
+typedef struct Coroutine {
+  ucontext_t context;
+  ucontext_t callerContext;
+  struct Coroutine *p_caller;
+  void *stack;
+  size_t stackSize;
+  bool finished;
+  CoroutineBody body;
+  void *p_data;
+  Generic *p_yielded;
+} Coroutine;
+
+// prototypes
+Coroutine *Coroutine_new(CoroutineBody, void *);
+Generic *Coroutine_resume(Coroutine *);
+void Coroutine_yield(Generic *);
+Coroutine *Coroutine_current();
+void Coroutine_free(Coroutine *);
+
+#endif
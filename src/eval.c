@@ -4,6 +4,58 @@
 #include "ast.h"
 #include "generic.h"
 #include "scope.h"
+#include "eval.h"
+#include "stdlib.h"
+#include "list.h"
+#include "sequence.h"
+#include "fold.h"
+#include "inline.h"
+#include "fuse.h"
+
+// evaluates the first argument of a fused application (see fuse.c)
+// if p_head applies a builtin producer (ie. range or map), returns a sequence instead of a list, else evaluates normally
+// sets *p_converted if a sequence was returned where a list would have been returned otherwise
+Generic *evalFused(AstNode *p_head, Scope *p_scope, int depth, bool *p_converted) {
+  // the fusion pass only flags producers applied by name, so this is a scope lookup
+  Generic *func = eval(p_head->p_headChild, p_scope, depth + 1);
+
+  // producers whose callback could have effects are evaluated as usual, so every item is applied before the consumer runs
+  if (!isFusedProducer(func) || !isFusionValid(p_head, p_scope)) {
+    if (func->refCount == 0) Generic_free(func);
+    return eval(p_head, p_scope, depth);
+  }
+
+  // collect arguments, the first being fused as well if this producer is also a consumer (ie. map of map)
+  int count = 0;
+  for (AstNode *p_curr = p_head->p_headChild->p_next; p_curr != NULL; p_curr = p_curr->p_next) count++;
+
+  Generic **args = (Generic **) malloc(sizeof(Generic *) * (count + 1));
+  bool argConverted = false;
+
+  AstNode *p_curr = p_head->p_headChild->p_next;
+  for (int i = 0; i < count; i++) {
+    if (i == 0 && p_head->fused) args[i] = evalFused(p_curr, p_scope, depth + 1, &argConverted);
+    else args[i] = eval(p_curr, p_scope, depth + 1);
+
+    args[i]->refCount++;
+    p_curr = p_curr->p_next;
+  }
+
+  // a sequence passed to a producer is returned as a sequence anyway, only lists (or range's integer) are converted
+  *p_converted = count > 0 && (argConverted || args[0]->type != TYPE_SEQUENCE);
+
+  Generic *res = applyFusedProducer(func, args, count, p_head->lineNumber);
+
+  for (int i = 0; i < count; i++) {
+    args[i]->refCount--;
+    if (args[i]->refCount == 0) Generic_free(args[i]);
+  }
+
+  free(args);
+  if (func->refCount == 0) Generic_free(func);
+
+  return res;
+}
 
 // evaluates an ast in a given scope
 Generic *eval(AstNode *p_head, Scope *p_scope, int depth) {
@@ -78,8 +130,8 @@ Generic *eval(AstNode *p_head, Scope *p_scope, int depth) {
 
   } else if (p_head->opcode == OP_FUNCTION) {
     // function case
-    // returns a function generic, whose value is a pointer to the functions ast node
-    return Generic_new(TYPE_FUNCTION, AstNode_copy(p_head, 0), 0);
+    // returns a function generic, whose value is a pointer to the functions ast node, shared rather than copied
+    return Generic_new(TYPE_FUNCTION, AstNode_share(p_head), 0);
 
   } else if (p_head->opcode == OP_APPLICATION) {
     // throw error for empty application
@@ -92,6 +144,15 @@ Generic *eval(AstNode *p_head, Scope *p_scope, int depth) {
       exit(0);
     }
 
+    // folded applications were evaluated by the folding pass, if they still apply the same builtins
+    if (p_head->p_constant != NULL && isFoldValid(p_head, p_scope)) return Generic_copy(p_head->p_constant);
+
+    // inlined applications evaluate the callee's body in place, if the callee is still the same function
+    if (p_head->p_inlined != NULL) {
+      Generic *res = evalInlined(p_head, p_scope, depth);
+      if (res != NULL) return res;
+    }
+
     // application case
     // get function
     Generic *func = eval(p_head->p_headChild, p_scope, depth + 1);
@@ -164,11 +225,16 @@ Generic *eval(AstNode *p_head, Scope *p_scope, int depth) {
       // second round, append to list
       Generic *args[count];
 
+      // fused applications get a sequence as their first argument, instead of an intermediate list
+      bool fused = p_head->fused && isFusedConsumer(func) && isFusionValid(p_head, p_scope);
+      bool converted = false;
+
       int i = 0;
       p_curr = p_head->p_headChild->p_next;
 
       while (i < count) {
-        args[i] = eval(p_curr, p_scope, depth + 1);
+        if (i == 0 && fused) args[i] = evalFused(p_curr, p_scope, depth + 1, &converted);
+        else args[i] = eval(p_curr, p_scope, depth + 1);
         args[i]->refCount++;
 
         i++;
@@ -178,6 +244,13 @@ Generic *eval(AstNode *p_head, Scope *p_scope, int depth) {
       // call and return
       Generic *res = (*cb)(p_local, args, count, p_head->lineNumber);
 
+      // consumers which return a list (ie. map) return a sequence when given one, so collect it
+      if (converted && res->type == TYPE_SEQUENCE) {
+        Generic *p_list = Generic_new(TYPE_LIST, Sequence_collect((Sequence *) res->p_val, p_local, p_head->lineNumber), 0);
+        Generic_free(res);
+        res = p_list;
+      }
+
       // drop ref count for args, and free if refCount is 0
       for (int i = 0; i < count; i++) {
         args[i]->refCount--;
@@ -192,6 +265,22 @@ Generic *eval(AstNode *p_head, Scope *p_scope, int depth) {
       
       return res;
 
+    } else if (func->type == TYPE_MEMO) {
+      // memoized functions look up their cache before calling, see memo.c
+      int count = 0;
+      for (AstNode *p_curr = p_head->p_headChild->p_next; p_curr != NULL; p_curr = p_curr->p_next) count++;
+
+      Generic *args[count + 1];
+      AstNode *p_curr = p_head->p_headChild->p_next;
+
+      for (int i = 0; i < count; i++) {
+        args[i] = eval(p_curr, p_scope, depth + 1);
+        p_curr = p_curr->p_next;
+      }
+
+      // applyFunc frees unreferenced args, and func if it is unreferenced
+      return applyFunc(func, p_scope, args, count, p_head->lineNumber);
+
     } else {
       // if func is not a function type, throw error
       printf(
@@ -1,111 +1,248 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdbool.h>
 #include <unistd.h>
 #include <termios.h>
-#include <ctype.h>
 #include <string.h>
+#include <pthread.h>
+#include <signal.h>
+#include <poll.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/ioctl.h>
 #include "events.h"
 
+// size of the buffer input is read into, which holds many whole escape codes
+#define EVENT_BUFFER_SIZE 256
+
+// milliseconds to wait for the rest of an escape code, once its start is read
+#define ESCAPE_TIMEOUT 100
+
 // stores original terminal settings
+// both settings are only written by initEvents, before any other thread starts
 struct termios orig_termios;
 
 // stores terminal settings for while the program is running (echo off)
 struct termios run_termios;
 
+// held while reading an event, so that threads do not read parts of each other's events
+pthread_mutex_t eventLock = PTHREAD_MUTEX_INITIALIZER;
+
+// number of times the terminal has been resized, counted on SIGWINCH
+volatile sig_atomic_t resizeCount = 0;
+
+// size of the terminal, read again only once it is resized (sizeReadAt is the resizeCount it was read at)
+pthread_mutex_t sizeLock = PTHREAD_MUTEX_INITIALIZER;
+int terminalRows = 0;
+int terminalColumns = 0;
+int sizeReadAt = -1;
+
+void handleResize(int signum) {
+  resizeCount++;
+}
+
+// returns the number of times the terminal has been resized, so that callers can tell if it changed
+int getResizeCount() {
+  return resizeCount;
+}
+
+// gets the number of rows and columns in the terminal
+void getTerminalSize(int *p_rows, int *p_columns) {
+  pthread_mutex_lock(&sizeLock);
+
+  int count = resizeCount;
+  if (sizeReadAt != count) {
+    struct winsize w;
+    ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
+    terminalRows = w.ws_row;
+    terminalColumns = w.ws_col;
+    sizeReadAt = count;
+  }
+
+  *p_rows = terminalRows;
+  *p_columns = terminalColumns;
+
+  pthread_mutex_unlock(&sizeLock);
+}
+
+// number of callers that currently need raw mode, so that terminal settings only change on the first enable and last disable
+pthread_mutex_t rawLock = PTHREAD_MUTEX_INITIALIZER;
+int rawDepth = 0;
+
+// input read from stdin, but not yet returned as an event
+// a single read can hold several events (or part of one), so what is left is kept for the next call
+// only accessed while eventLock is held
+char pendingInput[EVENT_BUFFER_SIZE];
+int pendingStart = 0;
+int pendingLength = 0;
+
+// set once stdin reaches the end of its input, after which it is never polled again
+bool inputClosed = false;
+
 void disableRaw() {
-  // reset
-  printf("\e[?1000l");
-  fflush(stdout);
+  pthread_mutex_lock(&rawLock);
+  rawDepth--;
+
+  if (rawDepth == 0) {
+    // reset
+    printf("\e[?1000l");
+    fflush(stdout);
+
+    // input which was not read yet is kept, so that keys pressed between events are not lost
+    tcsetattr(STDIN_FILENO, TCSANOW, &run_termios);
+  }
 
-  tcsetattr(STDIN_FILENO, TCSAFLUSH, &run_termios);
+  pthread_mutex_unlock(&rawLock);
 }
 
 void enableRaw() {
+  pthread_mutex_lock(&rawLock);
+  rawDepth++;
 
-  // get standard settings
-  struct termios raw = orig_termios;
+  if (rawDepth == 1) {
+    // get standard settings
+    struct termios raw = orig_termios;
 
-  // set flags
-  raw.c_iflag &= ~(IXON);
-  raw.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
-  raw.c_oflag &= ~(OPOST);
-  raw.c_cc[VMIN] = 0;
-  raw.c_cc[VTIME] = 1;
+    // set flags
+    // reads never block, as poll is used to wait for input
+    raw.c_iflag &= ~(IXON);
+    raw.c_lflag &= ~(ECHO | ICANON | IEXTEN | ISIG);
+    raw.c_oflag &= ~(OPOST);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
 
-  // write settings back into terminal
-  tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+    // write settings back into terminal
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
 
-  // enable mouse
-  printf("\e[?1003h\e[?1006h");
+    // enable mouse
+    printf("\e[?1003h\e[?1006h");
 
-  // flush stdout
-  fflush(stdout);
+    // flush stdout
+    fflush(stdout);
+  }
+
+  pthread_mutex_unlock(&rawLock);
 }
 
-// reads a single char from stdin, assuming that raw is enabled
-char readChar() {
-  char c = '\0';
-  read(STDIN_FILENO, &c, 1);
+// gets the time in milliseconds, from an arbitrary starting point
+long long getMilliseconds() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (long long) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
 
-  // printf("%c\r\n", c);
-  // handle exit
-  if (iscntrl(c) && (c == 26 || c == 3)) exit(0);
-  return c;
+// waits up to timeout milliseconds (forever if negative) for input, and appends whatever is available to pendingInput
+// returns true if anything was read
+bool readInput(int timeout) {
+  // move what is left to the front of the buffer, to make room
+  if (pendingStart != 0) {
+    memmove(pendingInput, pendingInput + pendingStart, pendingLength);
+    pendingStart = 0;
+  }
+  if (pendingLength == EVENT_BUFFER_SIZE) return false;
+
+  // once stdin is closed, it is always ready, so only wait
+  if (inputClosed) {
+    poll(NULL, 0, timeout);
+    return false;
+  }
+
+  // wait for input (a resize may interrupt this, in which case nothing is read)
+  struct pollfd input = {.fd = STDIN_FILENO, .events = POLLIN};
+  if (poll(&input, 1, timeout) <= 0) return false;
+
+  // read as much as is available in one call
+  ssize_t count = read(STDIN_FILENO, pendingInput + pendingLength, EVENT_BUFFER_SIZE - pendingLength);
+  if (count == 0 || (count < 0 && errno != EAGAIN && errno != EINTR)) inputClosed = true;
+  if (count <= 0) return false;
+
+  pendingLength += count;
+  return true;
+}
+
+// gets the length of the first event in pendingInput, or 0 if it is only partially read
+int getEventLength() {
+  char *p_input = pendingInput + pendingStart;
+
+  // case where just a key was pressed
+  if (p_input[0] != '\e') return 1;
+
+  // escape code case
+  if (pendingLength < 2) return 0;
+
+  if (p_input[1] == '[') {
+    // control sequence introducer case
+    // read more at https://en.wikipedia.org/wiki/ANSI_escape_code#CSIsection
+
+    // all escape sequences are terminated by a char in the range of 0x40 – 0x7E (64 - 126)
+    for (int i = 2; i < pendingLength; i++) {
+      if (64 <= p_input[i] && p_input[i] <= 126) return i + 1;
+    }
+    return 0;
+  }
+
+  if (p_input[1] == 'O') {
+    // \e O is used under certain cases to access function keys
+    // this escape code accepts the next char, thus this case is needed
+    return pendingLength < 3 ? 0 : 3;
+  }
+
+  return 2;
 }
 
-// returns the current event as a string, where the result is malloc
-char *event() {
-  // enable mouse events
-  enableRaw();
-
-  // string to return
-  char *res = malloc(sizeof(char) * 1);
-  res[0] = '\0';
-
-  // read first char
-  char c = readChar();
-
-  if (c == '\e') {
-    // escape code case
-    // increase memory, and add \e
-    res = realloc(res, sizeof(char) * (strlen(res) + 1 + 2));
-    strncat(res, &c, 1);
-
-    // read char again and add to result
-    c = readChar();
-    strncat(res, &c, 1);
-    
-    if (c == '[') {
-      // control sequence introducer case
-      // read more at https://en.wikipedia.org/wiki/ANSI_escape_code#CSIsection
-      
-      // all escape sequences are terminated by a char in the range of 0x40 – 0x7E (64 - 126)
-      // we loop until we find a terminator, and append to res
-      do {
-        res = realloc(res, sizeof(char) * (strlen(res) + 1 + 1));
-        c = readChar();
-        strncat(res, &c, 1);
-      } while (!(64 <= c && c <= 126));
-
-    } else if (c == 'O') {
-      // \e O is used under certain cases to access function keys
-      // this escape code accepts the next char, thus this case is needed
-      res = realloc(res, sizeof(char) * (strlen(res) + 1 + 1));
-      c = readChar();
-      strncat(res, &c, 1);
+// returns the next event as a string, waiting up to timeout milliseconds (forever if negative) for one, where the result is malloc
+// returns an empty string if no event is received, and assumes that raw is enabled
+char *event(int timeout) {
+  pthread_mutex_lock(&eventLock);
+
+  // wait for input, unless some is left over from the last read
+  long long deadline = getMilliseconds() + timeout;
+  while (pendingLength == 0) {
+    int remaining = -1;
+    if (timeout >= 0) {
+      long long left = deadline - getMilliseconds();
+      remaining = left > 0 ? (int) left : 0;
     }
 
-  } else if (c != '\0') {
-    // case where just a key was pressed, add memory, insert, and return
-    res = realloc(res, sizeof(char) * (strlen(res) + 1 + 1));
-    strncat(res, &c, 1);
+    if (!readInput(remaining) && remaining == 0) break;
+  }
+
+  // read until the first event is whole, giving up on the rest of an escape code if it does not arrive in time
+  int length = 0;
+  while (pendingLength > 0 && (length = getEventLength()) == 0) {
+    if (!readInput(ESCAPE_TIMEOUT)) {
+      length = pendingLength;
+      break;
+    }
+  }
+
+  // copy out the event
+  char *res = malloc(sizeof(char) * (length + 1));
+  memcpy(res, pendingInput + pendingStart, length);
+  res[length] = '\0';
+
+  pendingStart += length;
+  pendingLength -= length;
+
+  pthread_mutex_unlock(&eventLock);
+
+  // handle exit
+  for (int i = 0; i < length; i++) {
+    if (res[i] == 26 || res[i] == 3) exit(0);
   }
-  
-  // disable mouse events
-  disableRaw();
+
   return res;
 }
 
+// discards any input which has not been read as an event
+void discardInput() {
+  pthread_mutex_lock(&eventLock);
+  pendingStart = 0;
+  pendingLength = 0;
+  tcflush(STDIN_FILENO, TCIFLUSH);
+  pthread_mutex_unlock(&eventLock);
+}
+
 void exitEvents() {
   tcsetattr(STDIN_FILENO, TCSAFLUSH, &orig_termios);
   // \e[?1000l disables mouse events
@@ -117,4 +254,12 @@ void initEvents() {
   run_termios = orig_termios;
   run_termios.c_lflag &= ~(ECHO);
   atexit(exitEvents);
+
+  // count resizes, restarting any reads they interrupt
+  struct sigaction resize;
+  memset(&resize, 0, sizeof(resize));
+  resize.sa_handler = handleResize;
+  resize.sa_flags = SA_RESTART;
+  sigemptyset(&resize.sa_mask);
+  sigaction(SIGWINCH, &resize, NULL);
 }
\ No newline at end of file
@@ -5,10 +5,12 @@
 // prototypes
 void initEvents();
 void exitEvents();
-char *event();
-char readChar();
+char *event(int);
+void discardInput();
 void disableRaw();
 void enableRaw();
+int getResizeCount();
+void getTerminalSize(int *, int *);
 
 // stores original terminal settings
 extern struct termios orig_termios;
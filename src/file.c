@@ -75,30 +75,51 @@ char *normalizePath(char *path) {
 
 
 static FileCache fileCache = {
+  .lock = PTHREAD_MUTEX_INITIALIZER,
   .index = 0,
   .frozen = false
 };
 
 void FileCache_freeze() {
+  pthread_mutex_lock(&fileCache.lock);
   fileCache.frozen = true;
+  pthread_mutex_unlock(&fileCache.lock);
 }
 
-CachedFile *FileCache_read(char *path) {
+// returns a copy of the contents of the cached file at path, or NULL if it is not cached
+// copied while the cache is locked, as another thread may overwrite the entry
+char *FileCache_read(char *path) {
   char *normalizedPath = normalizePath(path);
+  char *res = NULL;
 
+  pthread_mutex_lock(&fileCache.lock);
   for (int i = 0; i < FILE_CACHE_SIZE; i++) {
     bool pathExists = fileCache.cache[i].path != NULL;
     if (pathExists && strcmp(fileCache.cache[i].path, normalizedPath) == 0) {
-      free(normalizedPath);
-      return &(fileCache.cache[i]);
+      res = malloc(fileCache.cache[i].fileLength + 1);
+      memcpy(res, fileCache.cache[i].contents, fileCache.cache[i].fileLength + 1);
+      break;
     }
   }
+  pthread_mutex_unlock(&fileCache.lock);
 
   free(normalizedPath);
-  return NULL;
+  return res;
 }
 
 void FileCache_write(char *path, char *contents, long fileLength) {
+  // normalize before locking, as normalizePath may exit
+  char *newPath = normalizePath(path);
+
+  pthread_mutex_lock(&fileCache.lock);
+
+  // frozen caches are never written to
+  if (fileCache.frozen) {
+    pthread_mutex_unlock(&fileCache.lock);
+    free(newPath);
+    return;
+  }
+
   // free item to write to
   if (fileCache.cache[fileCache.index].path != NULL) {
     free(fileCache.cache[fileCache.index].path);
@@ -111,8 +132,6 @@ void FileCache_write(char *path, char *contents, long fileLength) {
   char *newContents = malloc(fileLength + 1);
   memcpy(newContents, contents, fileLength + 1);
 
-  char *newPath = normalizePath(path);
-
   fileCache.cache[fileCache.index].path = newPath;
   fileCache.cache[fileCache.index].contents = newContents;
   fileCache.cache[fileCache.index].fileLength = fileLength;
@@ -120,9 +139,13 @@ void FileCache_write(char *path, char *contents, long fileLength) {
   // progress the write index
   fileCache.index += 1;
   fileCache.index %= FILE_CACHE_SIZE;
+
+  pthread_mutex_unlock(&fileCache.lock);
 }
 
 void FileCache_free() {
+  pthread_mutex_lock(&fileCache.lock);
+
   for (int i = 0; i < FILE_CACHE_SIZE; i++) {
     if (fileCache.cache[i].path != NULL) {
       free(fileCache.cache[i].path);
@@ -137,16 +160,14 @@ void FileCache_free() {
   }
 
   fileCache.index = 0;
+
+  pthread_mutex_unlock(&fileCache.lock);
 }
 
 char *readFile(char *path, bool cache) {
   if (cache) {
-    CachedFile *p_cachedFile = FileCache_read(path);
-    if (p_cachedFile != NULL) {
-      char *res = malloc(p_cachedFile->fileLength + 1);
-      memcpy(res, p_cachedFile->contents, p_cachedFile->fileLength + 1);
-      return res;
-    }
+    char *res = FileCache_read(path);
+    if (res != NULL) return res;
   }
 
   FILE *p_file = fopen(path, "r");
@@ -179,7 +200,7 @@ char *readFile(char *path, bool cache) {
   res[fileLength] = 0;
 
   // write to the cache so we do not need to open a new reader next time
-  if (cache && !fileCache.frozen) {
+  if (cache) {
     FileCache_write(path, res, fileLength);
   }
 
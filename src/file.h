@@ -2,6 +2,7 @@
 #define FILE_H
 #define FILE_CACHE_SIZE 1024
 #include <stdbool.h>
+#include <pthread.h>
 
 // an individual cached file, both path and contents are heap allocated
 typedef struct CachedFile {
@@ -11,7 +12,9 @@ typedef struct CachedFile {
 } CachedFile;
 
 // cache of files that were read
+// shared by every thread, so all access goes through lock
 typedef struct FileCache {
+  pthread_mutex_t lock;
   int index;
   bool frozen;
   CachedFile cache[FILE_CACHE_SIZE];
@@ -0,0 +1,101 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "fold.h"
+#include "ast.h"
+#include "generic.h"
+#include "scope.h"
+#include "stdlib.h"
+
+// folding pass
+// finds applications of pure builtins (ie. add or list) to constants, like (multiply 60 60 24)
+// these are evaluated once, and the result is stored in the application's p_constant
+// names are only matched here, eval checks that they are still bound to the builtins before using the constant (see isFoldValid)
+// so applications are evaluated normally wherever a name like add is shadowed
+
+// returns true if p_node is a literal, or a folded application
+bool isConstant(AstNode *p_node) {
+  return (
+    p_node->opcode == OP_INT || p_node->opcode == OP_FLOAT || p_node->opcode == OP_STRING
+    || p_node->p_constant != NULL
+  );
+}
+
+// returns a new generic holding the value of a constant node
+Generic *getConstant(AstNode *p_node) {
+  if (p_node->p_constant != NULL) return Generic_copy(p_node->p_constant);
+
+  if (p_node->opcode == OP_INT) {
+    int *p_val = (int *) malloc(sizeof(int));
+    *p_val = atoi(p_node->val);
+    return Generic_new(TYPE_INT, p_val, 0);
+  } else if (p_node->opcode == OP_FLOAT) {
+    double *p_val = (double *) malloc(sizeof(double));
+    *p_val = atof(p_node->val);
+    return Generic_new(TYPE_FLOAT, p_val, 0);
+  }
+
+  char **p_val = (char **) malloc(sizeof(char *));
+  *p_val = (char *) malloc(sizeof(char) * (strlen(p_node->val) + 1));
+  strcpy(*p_val, p_node->val);
+  return Generic_new(TYPE_STRING, p_val, 0);
+}
+
+// folds an application, if it applies a pure builtin to constants
+void foldApplication(AstNode *p_head) {
+  AstNode *p_func = p_head->p_headChild;
+  if (p_func == NULL || p_func->opcode != OP_IDENTIFIER) return;
+
+  int count = 0;
+  for (AstNode *p_curr = p_func->p_next; p_curr != NULL; p_curr = p_curr->p_next) {
+    if (!isConstant(p_curr)) return;
+    count++;
+  }
+
+  Generic *args[count + 1];
+  AstNode *p_curr = p_func->p_next;
+  for (int i = 0; i < count; i++) {
+    args[i] = getConstant(p_curr);
+    args[i]->refCount++;
+    p_curr = p_curr->p_next;
+  }
+
+  Generic *res = foldPureBuiltin(p_func->val, args, count);
+
+  for (int i = 0; i < count; i++) Generic_free(args[i]);
+
+  // hold the result, so that it lives as long as the node
+  if (res != NULL) {
+    p_head->p_constant = res;
+    res->refCount++;
+  }
+}
+
+// folds every foldable application in an ast, innermost first
+void fold(AstNode *p_head) {
+  // for each child
+  AstNode *p_curr = p_head->p_headChild;
+  while (p_curr != NULL) {
+    fold(p_curr);
+    p_curr = p_curr->p_next;
+  }
+
+  // inlined bodies often apply builtins to constants, once arguments are substituted (see inline.c)
+  if (p_head->p_inlined != NULL) fold(p_head->p_inlined);
+
+  if (p_head->opcode == OP_APPLICATION) foldApplication(p_head);
+}
+
+// returns true if the constant of a folded application can be used in p_scope
+// that is, if every builtin it was folded from is still bound to the same name
+bool isFoldValid(AstNode *p_head, Scope *p_scope) {
+  AstNode *p_func = p_head->p_headChild;
+  if (!isPureBuiltin(p_func->val, Scope_get(p_scope, p_func->val, p_func->lineNumber))) return false;
+
+  for (AstNode *p_curr = p_func->p_next; p_curr != NULL; p_curr = p_curr->p_next) {
+    if (p_curr->p_constant != NULL && !isFoldValid(p_curr, p_scope)) return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,11 @@
+#ifndef FOLD_H
+#define FOLD_H
+#include <stdbool.h>
+#include "ast.h"
+#include "scope.h"
+
+// prototypes
+void fold(AstNode *);
+bool isFoldValid(AstNode *, Scope *);
+
+#endif
@@ -0,0 +1,115 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "fuse.h"
+#include "ast.h"
+#include "scope.h"
+#include "stdlib.h"
+
+// fusion pass
+// finds chains like (reduce (map (range n) f) g), where a list built by one builtin is immediately consumed by another
+// the consumer is flagged, and at runtime (see eval.c) its first argument is evaluated as a lazy sequence instead
+// names are only matched here, eval checks that they are still bound to the builtins before fusing
+// so chains are left alone wherever a name like map is shadowed
+//
+// fused chains apply callbacks item by item, so a producer's callback is called in a different order (interleaved
+// with the consumer's), and not at all for items after an error
+// so chains are only fused if both callbacks are functions which only apply pure builtins, which have no effects
+
+// builtins which consume their first argument item by item
+// find is left out, as it stops at the first match, so errors later items would raise are never raised
+char *consumers[] = {"reduce", "length", "map", "filter"};
+
+// builtins which can produce a lazy sequence in place of a list
+char *producers[] = {"range", "map", "filter"};
+
+// returns true if p_node is an application of an identifier in names
+bool isApplicationOf(AstNode *p_node, char *names[], int count) {
+  if (p_node == NULL || p_node->opcode != OP_APPLICATION) return false;
+
+  AstNode *p_func = p_node->p_headChild;
+  if (p_func == NULL || p_func->opcode != OP_IDENTIFIER) return false;
+
+  for (int i = 0; i < count; i++) {
+    if (strcmp(p_func->val, names[i]) == 0) return true;
+  }
+
+  return false;
+}
+
+// returns the callback passed to a producer or consumer (ie. f in (map arr f)), or NULL if it takes none
+AstNode *getCallback(AstNode *p_app) {
+  if (strcmp(p_app->p_headChild->val, "range") == 0) return NULL;
+
+  AstNode *p_arr = p_app->p_headChild->p_next;
+  return p_arr == NULL ? NULL : p_arr->p_next;
+}
+
+// returns true if an expression only applies pure builtins by name (see stdlib.c)
+// parameters and assignments must not shadow those names, else the builtins could be bound to anything
+bool appliesOnlyPureBuiltins(AstNode *p_head) {
+  if (p_head->opcode == OP_APPLICATION) {
+    AstNode *p_func = p_head->p_headChild;
+    if (p_func == NULL || p_func->opcode != OP_IDENTIFIER || !isPureBuiltinName(p_func->val)) return false;
+  }
+
+  // for each child
+  AstNode *p_curr = p_head->p_headChild;
+  while (p_curr != NULL) {
+    bool binds = p_head->opcode == OP_FUNCTION || p_head->opcode == OP_ASSIGNMENT;
+    if (binds && p_curr->opcode == OP_IDENTIFIER && isPureBuiltinName(p_curr->val)) return false;
+    if (!appliesOnlyPureBuiltins(p_curr)) return false;
+    p_curr = p_curr->p_next;
+  }
+
+  return true;
+}
+
+// returns true if applying the callback of a producer or consumer has no effects
+bool hasPureCallback(AstNode *p_app) {
+  AstNode *p_callback = getCallback(p_app);
+  return p_callback == NULL || (p_callback->opcode == OP_FUNCTION && appliesOnlyPureBuiltins(p_callback));
+}
+
+// returns true if every builtin applied by an expression is still bound to the same name in p_scope
+bool isBoundToPureBuiltins(AstNode *p_head, Scope *p_scope) {
+  if (p_head->opcode == OP_APPLICATION) {
+    AstNode *p_func = p_head->p_headChild;
+    if (!isPureBuiltin(p_func->val, Scope_get(p_scope, p_func->val, p_func->lineNumber))) return false;
+  }
+
+  // for each child
+  AstNode *p_curr = p_head->p_headChild;
+  while (p_curr != NULL) {
+    if (!isBoundToPureBuiltins(p_curr, p_scope)) return false;
+    p_curr = p_curr->p_next;
+  }
+
+  return true;
+}
+
+// returns true if a producer or consumer flagged by the fusion pass can be fused in p_scope
+// that is, if its callback still only applies pure builtins
+bool isFusionValid(AstNode *p_app, Scope *p_scope) {
+  AstNode *p_callback = getCallback(p_app);
+  return p_callback == NULL || isBoundToPureBuiltins(p_callback, p_scope);
+}
+
+// flags every fusable application in an ast
+void fuse(AstNode *p_head) {
+  if (
+    isApplicationOf(p_head, consumers, sizeof(consumers) / sizeof(char *))
+    && isApplicationOf(p_head->p_headChild->p_next, producers, sizeof(producers) / sizeof(char *))
+    && hasPureCallback(p_head)
+    && hasPureCallback(p_head->p_headChild->p_next)
+  ) {
+    p_head->fused = true;
+  }
+
+  // for each child
+  AstNode *p_curr = p_head->p_headChild;
+  while (p_curr != NULL) {
+    fuse(p_curr);
+    p_curr = p_curr->p_next;
+  }
+}
@@ -0,0 +1,11 @@
+#ifndef FUSE_H
+#define FUSE_H
+#include <stdbool.h>
+#include "ast.h"
+#include "scope.h"
+
+// prototypes
+void fuse(AstNode *);
+bool isFusionValid(AstNode *, Scope *);
+
+#endif
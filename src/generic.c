@@ -4,6 +4,10 @@
 #include "generic.h"
 #include "ast.h"
 #include "list.h"
+#include "map.h"
+#include "sequence.h"
+#include "channel.h"
+#include "memo.h"
 
 // print generic nicely
 void Generic_print(Generic *in) {
@@ -21,8 +25,15 @@ void Generic_print(Generic *in) {
     printf("[Native Function]");
   } else if (in->type == TYPE_LIST) {
     List_print((List *) (in->p_val));
+  } else if (in->type == TYPE_MAP) {
+    Map_print((Map *) (in->p_val));
+  } else if (in->type == TYPE_SEQUENCE) {
+    printf("[Sequence]");
+  } else if (in->type == TYPE_CHANNEL) {
+    printf("[Channel]");
+  } else if (in->type == TYPE_MEMO) {
+    printf("[Memoized Function]");
   }
-  fflush(stdout);
 }
 
 // create a new generic and return
@@ -31,6 +42,7 @@ Generic* Generic_new(enum Type type, void *p_val, int refCount) {
   res->type = type;
   res->p_val = p_val;
   res->refCount = refCount;
+  res->hash = 0;
   return res;
 }
 
@@ -41,8 +53,16 @@ void Generic_free(Generic *target) {
 
   if (target->type == TYPE_LIST) {
     List_free((List *) (target->p_val)); // use list's own free function
+  } else if (target->type == TYPE_MAP) {
+    Map_free((Map *) (target->p_val));
+  } else if (target->type == TYPE_SEQUENCE) {
+    Sequence_free((Sequence *) (target->p_val));
+  } else if (target->type == TYPE_CHANNEL) {
+    Channel_free((Channel *) (target->p_val));
+  } else if (target->type == TYPE_MEMO) {
+    Memo_free((Memo *) (target->p_val));
   } else if (target->type == TYPE_FUNCTION) {
-    AstNode_free(target->p_val); // functions are in reality ast nodes, so free them with the appropriate function
+    AstNode_free(target->p_val); // functions are in reality (shared) ast nodes, so release them with the appropriate function
   } else if (target->type != TYPE_NATIVEFUNCTION) {
     // dont free native functions, as their void pointers are not allocated to heap
     free(target->p_val);
@@ -64,6 +84,10 @@ char *getTypeString(enum Type type) {
     case TYPE_VOID: return "void";
     case TYPE_NATIVEFUNCTION: return "native function";
     case TYPE_LIST: return "list";
+    case TYPE_MAP: return "map";
+    case TYPE_SEQUENCE: return "sequence";
+    case TYPE_CHANNEL: return "channel";
+    case TYPE_MEMO: return "memoized function";
     default: return "unknown";
   }
 }
@@ -73,12 +97,16 @@ Generic *Generic_copy(Generic *target) {
   res->type = target->type;
   res->refCount = 0;
 
+  // copies have the same structure, so they share the hash
+  // functions are compared by identity, and copying one creates a new function (sharing the same ast)
+  res->hash = target->type == TYPE_FUNCTION ? 0 : __atomic_load_n(&target->hash, __ATOMIC_RELAXED);
+
   if (res->type == TYPE_STRING) {
     res->p_val = (char **) malloc(sizeof(char *));
     *((char **) res->p_val) = malloc(sizeof(char) * (strlen(*((char **) target->p_val)) + 1));
     strcpy(*((char **) res->p_val), *((char **) target->p_val));
   } else if (res->type == TYPE_FUNCTION) {
-    res->p_val = AstNode_copy(target->p_val, 0);
+    res->p_val = AstNode_share(target->p_val);
   } else if (res->type == TYPE_NATIVEFUNCTION) {
     res->p_val = target->p_val;
   } else if (res->type == TYPE_VOID) {
@@ -91,8 +119,95 @@ Generic *Generic_copy(Generic *target) {
     *((double *) res->p_val) = *((double *) target->p_val);
   } else if (res->type == TYPE_LIST) {
     res->p_val = List_copy((List *) target->p_val);
+  } else if (res->type == TYPE_MAP) {
+    res->p_val = Map_copy((Map *) target->p_val);
+  } else if (res->type == TYPE_SEQUENCE) {
+    res->p_val = Sequence_copy((Sequence *) target->p_val);
+  } else if (res->type == TYPE_CHANNEL) {
+    res->p_val = Channel_copy((Channel *) target->p_val);
+  } else if (res->type == TYPE_MEMO) {
+    res->p_val = Memo_copy((Memo *) target->p_val);
+  }
+
+  return res;
+}
+
+// mixes the bits of x into a 32 bit hash (splitmix64 finalizer)
+unsigned int mixHash(unsigned long long x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return (unsigned int) (x ^ (x >> 32));
+}
+
+// hashes a number
+// integers are hashed as floats, as (is 1 1.0) is true
+unsigned int hashNumber(double val) {
+  // -0.0 is 0.0
+  if (val == 0) val = 0;
+
+  unsigned long long bits;
+  memcpy(&bits, &val, sizeof(bits));
+  return mixHash(bits);
+}
+
+// hashes a string (FNV-1a)
+unsigned int hashString(char *str) {
+  unsigned int res = 2166136261u;
+  for (unsigned char *p_curr = (unsigned char *) str; *p_curr != '\0'; p_curr++) {
+    res ^= *p_curr;
+    res *= 16777619u;
+  }
+
+  return res;
+}
+
+// returns a hash of the value in target, such that if Generic_is(a, b), Generic_hash(a) == Generic_hash(b)
+// the hash is computed once, and cached in target
+// values in maps are shared between threads, so the cache is read and written atomically (any thread computes the same hash)
+unsigned int Generic_hash(Generic *target) {
+  unsigned int cached = __atomic_load_n(&target->hash, __ATOMIC_RELAXED);
+  if (cached != 0) return cached;
+
+  unsigned int res = 0;
+
+  switch (target->type) {
+    case TYPE_INT:
+      res = hashNumber(*((int *) target->p_val));
+      break;
+    case TYPE_FLOAT:
+      res = hashNumber(*((double *) target->p_val));
+      break;
+    case TYPE_STRING:
+      res = hashString(*((char **) target->p_val));
+      break;
+    case TYPE_VOID:
+      res = 0x9e3779b9u;
+      break;
+    case TYPE_FUNCTION:
+      // functions share their ast, so they are hashed by the generic holding them
+      res = mixHash((unsigned long long) (size_t) target);
+      break;
+    case TYPE_NATIVEFUNCTION:
+    case TYPE_SEQUENCE:
+    case TYPE_CHANNEL:
+    case TYPE_MEMO:
+      res = mixHash((unsigned long long) (size_t) target->p_val);
+      break;
+    case TYPE_LIST:
+      res = List_hash((List *) target->p_val);
+      break;
+    case TYPE_MAP:
+      res = Map_hash((Map *) target->p_val);
+      break;
   }
 
+  // 0 is reserved for hashes that were not computed
+  if (res == 0) res = 1;
+
+  __atomic_store_n(&target->hash, res, __ATOMIC_RELAXED);
   return res;
 }
 
@@ -114,6 +229,12 @@ int Generic_is(Generic *a, Generic *b) {
   // else check types
   if (a->type == b->type) {
 
+    // values with different hashes can never be the same
+    // only use hashes that were already computed, as computing a hash walks the whole value
+    unsigned int hashA = __atomic_load_n(&a->hash, __ATOMIC_RELAXED);
+    unsigned int hashB = __atomic_load_n(&b->hash, __ATOMIC_RELAXED);
+    if (hashA != 0 && hashB != 0 && hashA != hashB) return 0;
+
     // do type conversions and check data
     switch (a->type) {
       case TYPE_FLOAT:
@@ -123,7 +244,7 @@ int Generic_is(Generic *a, Generic *b) {
         if (*((int *) a->p_val) == *((int *) b->p_val)) res = 1;
         break;
       case TYPE_STRING:
-        if (strcmp(*((char **) a->p_val), *((char **) b->p_val)) == 0) res = 1;
+        if (a == b || strcmp(*((char **) a->p_val), *((char **) b->p_val)) == 0) res = 1;
         break;
       case TYPE_VOID:
         res = 1;
@@ -132,10 +253,23 @@ int Generic_is(Generic *a, Generic *b) {
         if (a->p_val == b->p_val) res = 1;
         break;
       case TYPE_FUNCTION:
+        // functions share their ast, so they are compared by the generic holding them
+        if (a == b) res = 1;
+        break;
+      case TYPE_SEQUENCE:
+        // sequences are only computed when consumed, so they are compared by identity
+        if (a->p_val == b->p_val) res = 1;
+        break;
+      case TYPE_CHANNEL:
+      case TYPE_MEMO:
+        // channels and memos are shared, so they are compared by identity
         if (a->p_val == b->p_val) res = 1;
         break;
       case TYPE_LIST:
-        res = List_compare((List *) a->p_val, (List *) b->p_val);
+        res = a == b || List_compare((List *) a->p_val, (List *) b->p_val);
+        break;
+      case TYPE_MAP:
+        res = a == b || Map_compare((Map *) a->p_val, (Map *) b->p_val);
     }
   }
 
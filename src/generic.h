@@ -9,16 +9,23 @@ enum Type {
   TYPE_VOID,
   TYPE_FUNCTION,
   TYPE_NATIVEFUNCTION,
-  TYPE_LIST
+  TYPE_LIST,
+  TYPE_MAP,
+  TYPE_SEQUENCE,
+  TYPE_CHANNEL,
+  TYPE_MEMO
 };
 
 // generic struct
 // p_val: a void pointer to the value
 // type: the type of *p_val
+// hash: cached structural hash of the value, 0 if not yet computed (see Generic_hash)
+// refCount: not atomic, a generic is only ever referenced by one thread (see Scope_newIsolated)
 typedef struct Generic {
   enum Type type;
   void *p_val;
   int refCount;
+  unsigned int hash;
 } Generic;
 
 // prototypes
@@ -27,5 +34,8 @@ void Generic_print(Generic *);
 Generic *Generic_new(enum Type, void *, int refCount);
 void Generic_free(Generic *);
 Generic *Generic_copy(Generic *);
+unsigned int hashNumber(double);
+unsigned int hashString(char *);
+unsigned int Generic_hash(Generic *);
 int Generic_is(Generic *, Generic *);
 #endif
\ No newline at end of file
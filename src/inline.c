@@ -0,0 +1,320 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "inline.h"
+#include "ast.h"
+#include "generic.h"
+#include "scope.h"
+#include "stdlib.h"
+#include "eval.h"
+#include "fold.h"
+
+// inlining pass
+// finds applications of small functions which are assigned once, like (inc 5) where inc = {x -> <- (add x 1)}
+// the callee's body is copied into the application (p_inlined), with its parameters replaced by the arguments, like (add 5 1)
+// so at runtime, the application skips creating a local scope for the call
+// names are only matched here, eval checks that the callee is still the same function before using the body (see evalInlined)
+//
+// as functions are dynamically scoped, any function called from the body could read the callee's parameters
+// so only bodies which return an application of pure builtins (ie. add, see stdlib.c) are inlined
+// arguments are only substituted if they are literals or identifiers, so evaluating them more than once has no effect
+
+// largest body (in nodes) which is inlined
+#define INLINE_MAX_NODES 16
+
+// ids given to inlinable functions, so that copies of a function (ie. function values) can be matched to it
+unsigned int nextInlineId = 1;
+
+// an assignment of name found in the ast, p_func is the function assigned, NULL if something else was assigned
+typedef struct InlineCandidate {
+  char *name;
+  AstNode *p_func;
+  int assignments;
+} InlineCandidate;
+
+typedef struct InlineCandidates {
+  InlineCandidate *items;
+  int length;
+  int capacity;
+} InlineCandidates;
+
+// returns the candidate for name, or NULL if name is never assigned
+InlineCandidate *findCandidate(InlineCandidates *p_candidates, char *name) {
+  for (int i = 0; i < p_candidates->length; i++) {
+    if (strcmp(p_candidates->items[i].name, name) == 0) return &p_candidates->items[i];
+  }
+
+  return NULL;
+}
+
+// records every assignment in an ast
+void collectCandidates(AstNode *p_head, InlineCandidates *p_candidates) {
+  if (p_head->opcode == OP_ASSIGNMENT) {
+    AstNode *p_name = p_head->p_headChild;
+    InlineCandidate *p_candidate = findCandidate(p_candidates, p_name->val);
+
+    if (p_candidate == NULL) {
+      if (p_candidates->length == p_candidates->capacity) {
+        p_candidates->capacity = p_candidates->capacity == 0 ? 8 : p_candidates->capacity * 2;
+        p_candidates->items = (InlineCandidate *) realloc(
+          p_candidates->items, sizeof(InlineCandidate) * p_candidates->capacity
+        );
+      }
+
+      p_candidate = &p_candidates->items[p_candidates->length];
+      p_candidate->name = p_name->val;
+      p_candidate->p_func = NULL;
+      p_candidate->assignments = 0;
+      p_candidates->length++;
+    }
+
+    p_candidate->assignments++;
+    p_candidate->p_func = p_name->p_next->opcode == OP_FUNCTION ? p_name->p_next : NULL;
+  }
+
+  // for each child
+  AstNode *p_curr = p_head->p_headChild;
+  while (p_curr != NULL) {
+    collectCandidates(p_curr, p_candidates);
+    p_curr = p_curr->p_next;
+  }
+}
+
+// returns the number of nodes in an expression, or -1 if it is not only made of literals, identifiers and applications
+int countExpressionNodes(AstNode *p_head) {
+  if (
+    p_head->opcode != OP_INT && p_head->opcode != OP_FLOAT && p_head->opcode != OP_STRING
+    && p_head->opcode != OP_IDENTIFIER && p_head->opcode != OP_APPLICATION
+  ) return -1;
+
+  int count = 1;
+  AstNode *p_curr = p_head->p_headChild;
+  while (p_curr != NULL) {
+    int childCount = countExpressionNodes(p_curr);
+    if (childCount == -1) return -1;
+
+    count += childCount;
+    p_curr = p_curr->p_next;
+  }
+
+  return count;
+}
+
+// returns the expression returned by a function, if its body is a single return of a small expression, else NULL
+AstNode *getInlineBody(AstNode *p_func) {
+  AstNode *p_statement = p_func->p_headChild;
+  while (p_statement->opcode != OP_STATEMENT) p_statement = p_statement->p_next;
+
+  AstNode *p_return = p_statement->p_headChild;
+  if (p_return == NULL || p_return->opcode != OP_RETURN || p_return->p_next != NULL) return NULL;
+
+  int count = countExpressionNodes(p_return->p_headChild);
+  if (count == -1 || count > INLINE_MAX_NODES) return NULL;
+
+  return p_return->p_headChild;
+}
+
+// returns the number of times name is used in an expression
+int countUses(AstNode *p_head, char *name) {
+  int count = p_head->opcode == OP_IDENTIFIER && strcmp(p_head->val, name) == 0;
+
+  AstNode *p_curr = p_head->p_headChild;
+  while (p_curr != NULL) {
+    count += countUses(p_curr, name);
+    p_curr = p_curr->p_next;
+  }
+
+  return count;
+}
+
+// returns true if p_func can be inlined where it is applied by name
+bool isInlinable(AstNode *p_func, char *name) {
+  AstNode *p_body = getInlineBody(p_func);
+
+  // recursive functions are not inlined
+  if (p_body == NULL || countUses(p_body, name) > 0) return false;
+
+  // a parameter declared twice is bound to the last argument, which is not worth handling
+  for (AstNode *p_param = p_func->p_headChild; p_param->opcode != OP_STATEMENT; p_param = p_param->p_next) {
+    for (AstNode *p_other = p_param->p_next; p_other->opcode != OP_STATEMENT; p_other = p_other->p_next) {
+      if (strcmp(p_param->val, p_other->val) == 0) return false;
+    }
+  }
+
+  return true;
+}
+
+// returns a copy of an expression, with every parameter replaced by a copy of its argument
+AstNode *substitute(AstNode *p_head, AstNode *p_params, AstNode *p_args) {
+  if (p_head->opcode == OP_IDENTIFIER) {
+    AstNode *p_arg = p_args;
+    for (AstNode *p_param = p_params; p_param->opcode != OP_STATEMENT; p_param = p_param->p_next) {
+      if (strcmp(p_param->val, p_head->val) == 0) return AstNode_copy(p_arg, 0);
+      p_arg = p_arg->p_next;
+    }
+  }
+
+  AstNode *p_res = AstNode_new(p_head->val, p_head->opcode, p_head->lineNumber);
+  AstNode *p_lastChild = NULL;
+
+  // for each child
+  AstNode *p_curr = p_head->p_headChild;
+  while (p_curr != NULL) {
+    AstNode_appendChild(p_res, &p_lastChild, substitute(p_curr, p_params, p_args));
+    p_curr = p_curr->p_next;
+  }
+
+  return p_res;
+}
+
+// returns true if every application in an expression applies a pure builtin by name
+bool appliesPureBuiltins(AstNode *p_head) {
+  if (p_head->opcode == OP_APPLICATION) {
+    AstNode *p_func = p_head->p_headChild;
+    if (p_func == NULL || p_func->opcode != OP_IDENTIFIER || !isPureBuiltinName(p_func->val)) return false;
+  }
+
+  // for each child
+  AstNode *p_curr = p_head->p_headChild;
+  while (p_curr != NULL) {
+    if (!appliesPureBuiltins(p_curr)) return false;
+    p_curr = p_curr->p_next;
+  }
+
+  return true;
+}
+
+// inlines p_func into an application of it, if the arguments allow it
+void inlineApplication(AstNode *p_head, AstNode *p_func) {
+  AstNode *p_body = getInlineBody(p_func);
+  AstNode *p_params = p_func->p_headChild;
+  AstNode *p_args = p_head->p_headChild->p_next;
+
+  AstNode *p_param = p_params;
+  AstNode *p_arg = p_args;
+
+  while (p_param->opcode != OP_STATEMENT && p_arg != NULL) {
+    bool literal = p_arg->opcode == OP_INT || p_arg->opcode == OP_FLOAT || p_arg->opcode == OP_STRING;
+
+    // unused identifiers are still evaluated by a call, which throws an error if they are undefined
+    if (!literal && (p_arg->opcode != OP_IDENTIFIER || countUses(p_body, p_param->val) == 0)) return;
+
+    p_param = p_param->p_next;
+    p_arg = p_arg->p_next;
+  }
+
+  // calls with the wrong number of arguments throw an error, leave them be
+  if (p_param->opcode != OP_STATEMENT || p_arg != NULL) return;
+
+  AstNode *p_res = substitute(p_body, p_params, p_args);
+
+  // identifiers passed as arguments may have named functions other than pure builtins
+  if (!appliesPureBuiltins(p_res)) {
+    AstNode_free(p_res);
+    return;
+  }
+
+  p_head->p_inlined = p_res;
+  p_head->inlineId = p_func->inlineId;
+}
+
+// inlines every application of an inlinable function in an ast
+void inlineApplications(AstNode *p_head, InlineCandidates *p_candidates) {
+  if (p_head->opcode == OP_APPLICATION && p_head->p_headChild != NULL && p_head->p_headChild->opcode == OP_IDENTIFIER) {
+    InlineCandidate *p_candidate = findCandidate(p_candidates, p_head->p_headChild->val);
+    if (p_candidate != NULL && p_candidate->p_func != NULL && p_candidate->p_func->inlineId != 0) {
+      inlineApplication(p_head, p_candidate->p_func);
+    }
+  }
+
+  // for each child
+  AstNode *p_curr = p_head->p_headChild;
+  while (p_curr != NULL) {
+    inlineApplications(p_curr, p_candidates);
+    p_curr = p_curr->p_next;
+  }
+}
+
+// inlines small functions, which are assigned once in an ast, where they are applied by name
+void inlineFunctions(AstNode *p_head) {
+  InlineCandidates candidates = {NULL, 0, 0};
+  collectCandidates(p_head, &candidates);
+
+  for (int i = 0; i < candidates.length; i++) {
+    InlineCandidate *p_candidate = &candidates.items[i];
+
+    if (
+      p_candidate->assignments == 1 && p_candidate->p_func != NULL
+      && isInlinable(p_candidate->p_func, p_candidate->name)
+    ) {
+      p_candidate->p_func->inlineId = __atomic_fetch_add(&nextInlineId, 1, __ATOMIC_RELAXED);
+    }
+  }
+
+  inlineApplications(p_head, &candidates);
+  free(candidates.items);
+}
+
+// evaluates an inlined body, applying its builtins directly
+// returns NULL as soon as an application does not apply the pure builtin it names in p_scope
+// as only pure builtins were applied before that, the call can then be evaluated as usual
+Generic *evalPure(AstNode *p_head, Scope *p_scope, int depth) {
+  if (p_head->opcode == OP_IDENTIFIER) return Scope_get(p_scope, p_head->val, p_head->lineNumber);
+  if (p_head->opcode != OP_APPLICATION) return eval(p_head, p_scope, depth);
+
+  AstNode *p_func = p_head->p_headChild;
+  Generic *func = Scope_get(p_scope, p_func->val, p_func->lineNumber);
+  if (!isPureBuiltin(p_func->val, func)) return NULL;
+
+  if (p_head->p_constant != NULL && isFoldValid(p_head, p_scope)) return Generic_copy(p_head->p_constant);
+
+  // collect arguments
+  int count = 0;
+  for (AstNode *p_curr = p_func->p_next; p_curr != NULL; p_curr = p_curr->p_next) count++;
+
+  Generic *args[count + 1];
+  AstNode *p_curr = p_func->p_next;
+
+  for (int i = 0; i < count; i++) {
+    args[i] = evalPure(p_curr, p_scope, depth + 1);
+
+    if (args[i] == NULL) {
+      for (int j = 0; j < i; j++) {
+        args[j]->refCount--;
+        if (args[j]->refCount == 0) Generic_free(args[j]);
+      }
+
+      return NULL;
+    }
+
+    args[i]->refCount++;
+    p_curr = p_curr->p_next;
+  }
+
+  // pure builtins do not use the scope, so there is no need for a local one
+  Generic *(*cb)(Scope *, Generic *[], int, int) = func->p_val;
+  Generic *res = cb(p_scope, args, count, p_head->lineNumber);
+
+  // drop ref count for args, and free if refCount is 0
+  for (int i = 0; i < count; i++) {
+    args[i]->refCount--;
+    if (args[i]->refCount == 0) Generic_free(args[i]);
+  }
+
+  return res;
+}
+
+// evaluates the inlined body of an application in place of the call
+// returns NULL if the callee is no longer the function that was inlined, or if its body no longer only applies pure builtins
+Generic *evalInlined(AstNode *p_head, Scope *p_scope, int depth) {
+  AstNode *p_func = p_head->p_headChild;
+  Generic *func = Scope_get(p_scope, p_func->val, p_func->lineNumber);
+  if (func->type != TYPE_FUNCTION || ((AstNode *) func->p_val)->inlineId != p_head->inlineId) return NULL;
+
+  Generic *res = evalPure(p_head->p_inlined, p_scope, depth + 1);
+
+  // like a return, values held elsewhere are copied
+  if (res == NULL || res->refCount == 0) return res;
+  return Generic_copy(res);
+}
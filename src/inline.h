@@ -0,0 +1,11 @@
+#ifndef INLINE_H
+#define INLINE_H
+#include "ast.h"
+#include "scope.h"
+#include "generic.h"
+
+// prototypes
+void inlineFunctions(AstNode *);
+Generic *evalInlined(AstNode *, Scope *, int);
+
+#endif
@@ -6,95 +6,129 @@
 #include "lex.h"
 #include "tokens.h"
 #include "string.h"
+#include "vector.h"
+
+__thread jmp_buf *p_syntaxErrorJump = NULL;
+
+// jumps to p_syntaxErrorJump if it is set, called before a syntax error is printed
+void jumpOnSyntaxError() {
+  if (p_syntaxErrorJump != NULL) longjmp(*p_syntaxErrorJump, 1);
+}
 
 // handles errors while scanning chars in a string
 void handleStringError(char c, int lineNumber) {
   if (c == '\n') {
+    jumpOnSyntaxError();
     printf("Syntax Error @ Line %i: Unexpected new line before string closed.\n", lineNumber);
     exit(0);
   }
 
   if (c == '\0') {
+    jumpOnSyntaxError();
     printf("Syntax Error @ Line %i: Unexpected end of file before string closed.\n", lineNumber);
     exit(0);
   }
 }
 
-// lex code with length fileLength into tokens
-int lex(Token *p_headToken, char *code, int fileLength) {
+// creates a lexer over code with length fileLength, which lexes tokens as they are asked for
+// code must outlive the lexer, as tokens are slices of it (see Token)
+Lexer *Lexer_new(char *code, int fileLength) {
+  Lexer *res = (Lexer *) malloc(sizeof(Lexer));
+  res->code = code;
+  res->length = fileLength;
+  res->index = 0;
+  res->lineNumber = 1;
+  res->ended = false;
+  res->p_buffer = TokenList_new();
+  res->cursor = 0;
+
+  TokenList_push(res->p_buffer, NULL, 0, false, TOK_START, 1);
+  return res;
+}
 
-  // token count
-  int tokenCount = 1;
+// lexes the next token of the lexer's code into its buffer
+// once the code runs out, lexes an end token, after which the lexer has ended
+void lexNext(Lexer *p_lexer) {
+  char *code = p_lexer->code;
+  int fileLength = p_lexer->length;
+  TokenList *p_tokens = p_lexer->p_buffer;
+  int tokenCount = p_tokens->length;
 
   // line number
-  int lineNumber = 1;
+  int lineNumber = p_lexer->lineNumber;
 
-  // for each char (including terminator, helps us not need to push number tokens if they are last)
-  int i = 0;
-  while (i < fileLength) {
-    char c = code[i];
+  // for each char, until a token is found
+  // runs of chars without meaning of their own (whitespace, comments, and the insides of strings and identifiers) are scanned in blocks (see vector.c)
+  int i = p_lexer->index;
+  while (i < fileLength && p_tokens->length == tokenCount) {
 
-    if (c == '\n') lineNumber++;
+    // skip whitespace, counting newlines
+    i = Vector_skipWhitespace(code, i, fileLength, &lineNumber);
+    if (i >= fileLength) break;
+
+    char c = code[i];
 
     if (c == '/' && code[i + 1] == '/') {
-      // comments
-      while (code[i] != '\n' && i < fileLength) i++;
+      // comments, skip to the newline
+      char *p_newline = memchr(&code[i], '\n', fileLength - i);
+      i = p_newline == NULL ? fileLength : p_newline - code;
       lineNumber++;
     } else if (c == '(') {
-      Token_push(p_headToken, NULL, TOK_APPLYOPEN, lineNumber);
-      tokenCount++;
+      TokenList_push(p_tokens, NULL, 0, false, TOK_APPLYOPEN, lineNumber);
     } else if (c == ')') {
-      Token_push(p_headToken, NULL, TOK_APPLYCLOSE, lineNumber);
-      tokenCount++;
+      TokenList_push(p_tokens, NULL, 0, false, TOK_APPLYCLOSE, lineNumber);
     } else if (c == '=') {
-      Token_push(p_headToken, NULL, TOK_ASSIGNMENT, lineNumber);
-      tokenCount++;
+      TokenList_push(p_tokens, NULL, 0, false, TOK_ASSIGNMENT, lineNumber);
     } else if (c == '{') {
-      Token_push(p_headToken, NULL, TOK_FUNCOPEN, lineNumber);
-      tokenCount++;
+      TokenList_push(p_tokens, NULL, 0, false, TOK_FUNCOPEN, lineNumber);
     } else if (c == '}') {
-      Token_push(p_headToken, NULL, TOK_FUNCCLOSE, lineNumber);
-      tokenCount++;
+      TokenList_push(p_tokens, NULL, 0, false, TOK_FUNCCLOSE, lineNumber);
     } else if (c == '-' && code[i + 1] == '>') {
-      Token_push(p_headToken, NULL, TOK_ARROW, lineNumber);
+      TokenList_push(p_tokens, NULL, 0, false, TOK_ARROW, lineNumber);
       i++;
-      tokenCount++;
     } else if (c == '<' && code[i + 1] == '-') {
-      Token_push(p_headToken, NULL, TOK_RETURN, lineNumber);
+      TokenList_push(p_tokens, NULL, 0, false, TOK_RETURN, lineNumber);
       i++;
-      tokenCount++;
     } else if (c == '"') {
       
       // record first char in string
       int stringStart = i + 1;
+      bool escaped = false;
 
       // go to first char after quotes
       i++;
 
       // count to last char in string (last quote)
-      while (code[i] != '"') {
+      // stopping only at quotes, escape codes, and the chars which are errors
+      while ((i = Vector_findStringEnd(code, i, fileLength)) < fileLength && code[i] != '"') {
 
         // error handling
         handleStringError(code[i], lineNumber);
         
         // skip escape codes
-        if (code[i] == '\\') {
-          i++;
-          handleStringError(code[i], lineNumber);
-        }
+        escaped = true;
+        i++;
+        handleStringError(code[i], lineNumber);
 
         i++;
       }
 
-      // get substring and add token
-      char *val = malloc(i - stringStart + 1);
-      strncpy(val, &code[stringStart], i - stringStart);
-      val[i - stringStart] = '\0';
-
-      Token_push(p_headToken, parseString(val), TOK_STRING, lineNumber);
-
-      free(val);
-      tokenCount++;
+      // end of file before string closed
+      if (i >= fileLength) handleStringError('\0', lineNumber);
+
+      if (escaped) {
+        // strings with escape codes are decoded from a copy of the substring
+        char *val = malloc(i - stringStart + 1);
+        strncpy(val, &code[stringStart], i - stringStart);
+        val[i - stringStart] = '\0';
+
+        char *decoded = parseString(val);
+        TokenList_push(p_tokens, decoded, strlen(decoded), true, TOK_STRING, lineNumber);
+        free(val);
+      } else {
+        // other strings are sliced from the source
+        TokenList_push(p_tokens, &code[stringStart], i - stringStart, false, TOK_STRING, lineNumber);
+      }
 
     } else if (isdigit((unsigned char) c) > 0 || (c == '-' && isdigit((unsigned char) code[i + 1]) > 0)) {
       
@@ -114,6 +148,7 @@ int lex(Token *p_headToken, char *code, int fileLength) {
         if (code[i] == '.') {
           if (isFloat) {
             // case were we saw a point before
+            jumpOnSyntaxError();
             printf("Syntax Error @ Line %i: Multiple decimal points in single number.\n", lineNumber);
             exit(0);
           } else isFloat = true;
@@ -122,14 +157,8 @@ int lex(Token *p_headToken, char *code, int fileLength) {
         i++;
       }
 
-      // get substring and add token
-      char *val = malloc(i - numStart + 1);
-      strncpy(val, &code[numStart], i - numStart);
-      val[i - numStart] = '\0';
-
-      if (isFloat) Token_push(p_headToken, val, TOK_FLOAT, lineNumber);
-      else Token_push(p_headToken, val, TOK_INT, lineNumber);
-      tokenCount++;
+      // add token, sliced from the source
+      TokenList_push(p_tokens, &code[numStart], i - numStart, false, isFloat ? TOK_FLOAT : TOK_INT, lineNumber);
 
       // make sure to go back to last char of number
       i--;
@@ -144,26 +173,23 @@ int lex(Token *p_headToken, char *code, int fileLength) {
       int identifierStart = i;
 
       // while valid identifier char
+      // -, < and / are valid, unless they start ->, <- or //
       while (
-        strchr(" \n\r\t\f\v{}()\"=", code[i]) == NULL 
+        (i = Vector_findIdentifierEnd(code, i, fileLength)) < fileLength
         && !(code[i] == '-' && code[i + 1] == '>') 
         && !(code[i] == '<' && code[i + 1] == '-')
         && !(code[i] == '/' && code[i + 1] == '/')
+        && (code[i] == '-' || code[i] == '<' || code[i] == '/')
       ) i++;
 
-      // get substring and add token
-      char *val = malloc(i - identifierStart + 1);
-      strncpy(val, &code[identifierStart], i - identifierStart);
-      val[i - identifierStart] = '\0';
-
-      Token_push(p_headToken, val, TOK_IDENTIFIER, lineNumber);
-
-      tokenCount++;
+      // add token, sliced from the source
+      TokenList_push(p_tokens, &code[identifierStart], i - identifierStart, false, TOK_IDENTIFIER, lineNumber);
       
       // make sure to go back to last char of identifier
       i--;
     } else if (strchr(" \n\r\t\f\v", code[i]) == NULL) {
       // handle unexpected char
+      jumpOnSyntaxError();
       printf("Syntax Error @ Line %i: Unexpected char \"%c\".\n", lineNumber, c);
       exit(0);
     }
@@ -171,8 +197,59 @@ int lex(Token *p_headToken, char *code, int fileLength) {
     i++;
   }
 
-  Token_push(p_headToken, NULL, TOK_END, lineNumber); 
-  tokenCount++;
+  // continue from here next time
+  p_lexer->index = i;
+  p_lexer->lineNumber = lineNumber;
+
+  if (p_tokens->length == tokenCount) {
+    TokenList_push(p_tokens, NULL, 0, false, TOK_END, lineNumber);
+    p_lexer->ended = true;
+  }
+}
+
+// returns the token offset tokens after the cursor, lexing up to it if needed
+// past the end of the code, returns the end token
+// the token may move once another token is lexed, so it should not be kept after peeking further
+Token *Lexer_peek(Lexer *p_lexer, int offset) {
+  while (p_lexer->cursor + offset >= p_lexer->p_buffer->length) {
+    if (p_lexer->ended) return &p_lexer->p_buffer->tokens[p_lexer->p_buffer->length - 1];
+    lexNext(p_lexer);
+  }
+
+  return &p_lexer->p_buffer->tokens[p_lexer->cursor + offset];
+}
+
+// consumes the token at the cursor
+void Lexer_advance(Lexer *p_lexer) {
+  Lexer_peek(p_lexer, 0);
+  if (p_lexer->cursor < p_lexer->p_buffer->length - 1 || !p_lexer->ended) p_lexer->cursor++;
+}
+
+// frees consumed tokens, keeping those after the cursor
+void Lexer_release(Lexer *p_lexer) {
+  TokenList *p_buffer = p_lexer->p_buffer;
+
+  for (int i = 0; i < p_lexer->cursor; i++) {
+    if (p_buffer->tokens[i].decoded) free(p_buffer->tokens[i].val);
+  }
+
+  p_buffer->length -= p_lexer->cursor;
+  memmove(p_buffer->tokens, &p_buffer->tokens[p_lexer->cursor], sizeof(Token) * p_buffer->length);
+  p_lexer->cursor = 0;
+}
+
+// frees a lexer, and any tokens it still holds
+void Lexer_free(Lexer *p_lexer) {
+  TokenList_free(p_lexer->p_buffer);
+  free(p_lexer);
+}
+
+// lex code with length fileLength into a list of tokens, starting with a start token, and ending with an end token
+TokenList *lex(char *code, int fileLength) {
+  Lexer *p_lexer = Lexer_new(code, fileLength);
+  while (!p_lexer->ended) lexNext(p_lexer);
 
-  return tokenCount;
+  TokenList *res = p_lexer->p_buffer;
+  free(p_lexer);
+  return res;
 }
\ No newline at end of file
@@ -1,8 +1,31 @@
 #ifndef LEX_H
 #define LEX_H
+#include <stdbool.h>
+#include <setjmp.h>
 #include "tokens.h"
 
-// prototype
-int lex(Token *, char *, int);
+// lexer, which lexes code into tokens as they are asked for, rather than all at once
+// p_buffer holds lexed tokens which have not been released, cursor is the index of the next token to consume in it
+typedef struct Lexer {
+  char *code;
+  int length;
+  int index;
+  int lineNumber;
+  bool ended;
+  TokenList *p_buffer;
+  int cursor;
+} Lexer;
+
+// while set, syntax errors jump to it rather than printing and exiting (see parseCode)
+extern __thread jmp_buf *p_syntaxErrorJump;
+
+// prototypes
+void jumpOnSyntaxError();
+Lexer *Lexer_new(char *, int);
+Token *Lexer_peek(Lexer *, int);
+void Lexer_advance(Lexer *);
+void Lexer_release(Lexer *);
+void Lexer_free(Lexer *);
+TokenList *lex(char *, int);
 
 #endif
\ No newline at end of file
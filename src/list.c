@@ -1,32 +1,158 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
 #include "list.h"
 #include "generic.h"
 
+// returns the storage a list would use if p_val was its only item
+enum ListStorage getItemStorage(Generic *p_val) {
+  if (p_val->type == TYPE_INT) return LIST_INT;
+  if (p_val->type == TYPE_FLOAT) return LIST_FLOAT;
+  return LIST_BOXED;
+}
+
+// returns the storage able to hold items from both a and b
+enum ListStorage mergeStorage(enum ListStorage a, enum ListStorage b) {
+  return a == b ? a : LIST_BOXED;
+}
+
+// returns the item at index of a packed list as a double
+double List_numberAt(List *p_target, int index) {
+  if (p_target->storage == LIST_INT) return p_target->ints[index];
+  return p_target->floats[index];
+}
+
 void List_print(List *p_target) {
   printf("[List: ");
 
   for (int i = 0; i < p_target->len; i += 1) {
-    Generic_print(p_target->vals[i]);
+    if (p_target->storage == LIST_INT) printf("%i", p_target->ints[i]);
+    else if (p_target->storage == LIST_FLOAT) printf("%f", p_target->floats[i]);
+    else Generic_print(p_target->vals[i]);
+
     if (i != p_target->len - 1)  printf(", ");
   }
 
   printf("]");
 }
 
+// allocate a list with room for length items, in the given storage
+// items are left unpopulated
+List *List_alloc(enum ListStorage storage, int length) {
+  List *res = (List *) malloc(sizeof(List));
+  res->storage = storage;
+  res->len = length;
+  res->vals = NULL;
+  res->ints = NULL;
+  res->floats = NULL;
+
+  if (storage == LIST_INT) res->ints = (int *) malloc(sizeof(int) * length);
+  else if (storage == LIST_FLOAT) res->floats = (double *) malloc(sizeof(double) * length);
+  else res->vals = (Generic **) malloc(sizeof(Generic *) * length);
+
+  return res;
+}
+
+// write a copy of p_val to index in p_target
+// p_val must fit in the storage of p_target
+void List_write(List *p_target, int index, Generic *p_val) {
+  if (p_target->storage == LIST_INT) p_target->ints[index] = *((int *) p_val->p_val);
+  else if (p_target->storage == LIST_FLOAT) p_target->floats[index] = *((double *) p_val->p_val);
+  else p_target->vals[index] = Generic_copy(p_val);
+}
+
+// copy count items from p_src (starting at srcIndex), into p_dst (starting at dstIndex)
+// items are boxed if p_dst is boxed and p_src is packed
+void List_copyRange(List *p_dst, int dstIndex, List *p_src, int srcIndex, int count) {
+  if (count <= 0) return;
+
+  if (p_dst->storage == LIST_INT && p_src->storage == LIST_INT) {
+    memcpy(&p_dst->ints[dstIndex], &p_src->ints[srcIndex], sizeof(int) * count);
+  } else if (p_dst->storage == LIST_FLOAT && p_src->storage == LIST_FLOAT) {
+    memcpy(&p_dst->floats[dstIndex], &p_src->floats[srcIndex], sizeof(double) * count);
+  } else {
+    for (int i = 0; i < count; i += 1) {
+      p_dst->vals[dstIndex + i] = List_get(p_src, srcIndex + i);
+    }
+  }
+}
+
 // copy a given list
 List *List_copy(List *p_target) {
-  return List_new(p_target->vals, p_target->len);
+  List *res = List_alloc(p_target->storage, p_target->len);
+  List_copyRange(res, 0, p_target, 0, p_target->len);
+  return res;
 }
 
 // make a new list struct, given a list of generics
+// numeric items are packed if they all share a type
 List *List_new(Generic **items, int length) {
-  List *res = (List *) malloc(sizeof(List));
-  res->vals = (Generic **) malloc(sizeof(Generic *) * length);
-  res->len = length;
-  
+  enum ListStorage storage = length > 0 ? getItemStorage(items[0]) : LIST_BOXED;
+  for (int i = 1; i < length; i += 1) storage = mergeStorage(storage, getItemStorage(items[i]));
+
+  List *res = List_alloc(storage, length);
+
   for (int i = 0; i < res->len; i += 1) {
-    res->vals[i] = Generic_copy(items[i]);
+    List_write(res, i, items[i]);
+  }
+
+  return res;
+}
+
+// make a new list struct, taking ownership of items (and the generics in it) instead of copying
+List *List_wrap(Generic **items, int length) {
+  enum ListStorage storage = length > 0 ? getItemStorage(items[0]) : LIST_BOXED;
+  for (int i = 1; i < length; i += 1) storage = mergeStorage(storage, getItemStorage(items[i]));
+
+  if (storage == LIST_BOXED) {
+    List *res = List_alloc(LIST_BOXED, 0);
+    free(res->vals);
+    res->vals = items;
+    res->len = length;
+    return res;
+  }
+
+  // pack, and free the boxed items
+  List *res = List_new(items, length);
+  for (int i = 0; i < length; i += 1) Generic_free(items[i]);
+  free(items);
+
+  return res;
+}
+
+// returns a packed copy of a list whose items are all numbers
+// lists mixing integers and floats are packed as floats
+// returns NULL if any item is not a number
+List *List_pack(List *p_target) {
+  if (p_target->storage != LIST_BOXED) return List_copy(p_target);
+
+  enum ListStorage storage = LIST_INT;
+  for (int i = 0; i < p_target->len; i += 1) {
+    enum ListStorage itemStorage = getItemStorage(p_target->vals[i]);
+    if (itemStorage == LIST_BOXED) return NULL;
+    if (itemStorage == LIST_FLOAT) storage = LIST_FLOAT;
+  }
+
+  List *res = List_alloc(storage, p_target->len);
+
+  for (int i = 0; i < p_target->len; i += 1) {
+    Generic *p_item = p_target->vals[i];
+
+    if (storage == LIST_INT) res->ints[i] = *((int *) p_item->p_val);
+    else if (p_item->type == TYPE_INT) res->floats[i] = *((int *) p_item->p_val);
+    else res->floats[i] = *((double *) p_item->p_val);
+  }
+
+  return res;
+}
+
+// returns a copy of a packed list, with all items converted to floats
+List *List_toFloats(List *p_target) {
+  List *res = List_alloc(LIST_FLOAT, p_target->len);
+
+  for (int i = 0; i < p_target->len; i += 1) {
+    res->floats[i] = List_numberAt(p_target, i);
   }
 
   return res;
@@ -34,77 +160,83 @@ List *List_new(Generic **items, int length) {
 
 // get item from list
 Generic *List_get(List *p_target, int index) {
+  if (p_target->storage == LIST_INT) {
+    // box packed int
+    int *p_val = (int *) malloc(sizeof(int));
+    *p_val = p_target->ints[index];
+    return Generic_new(TYPE_INT, p_val, 0);
+  } else if (p_target->storage == LIST_FLOAT) {
+    // box packed float
+    double *p_val = (double *) malloc(sizeof(double));
+    *p_val = p_target->floats[index];
+    return Generic_new(TYPE_FLOAT, p_val, 0);
+  }
+
   // return copy of generic
   return Generic_copy(p_target->vals[index]);
 }
 
 // insert item at index
 List *List_insert(List *p_target, Generic *p_val, int index) {
-  List *res = (List *) malloc(sizeof(List));
-  res->vals = (Generic **) malloc(sizeof(Generic *) * (p_target->len + 1));
-  res->len = p_target->len + 1;
-  
-  // resIndex is the index in the resulting list
-  // targetIndex is the index in the provided list
-  int targetIndex = 0;
-  for (int resIndex = 0; resIndex < res->len; resIndex += 1) {
-    if (resIndex == index) {
-      res->vals[index] = Generic_copy(p_val);
-      continue;
-    }
+  enum ListStorage storage = p_target->len == 0
+    ? getItemStorage(p_val)
+    : mergeStorage(p_target->storage, getItemStorage(p_val));
 
-    res->vals[resIndex] = Generic_copy(p_target->vals[targetIndex]);
-    targetIndex += 1;
-  }
+  List *res = List_alloc(storage, p_target->len + 1);
+
+  List_copyRange(res, 0, p_target, 0, index);
+  List_write(res, index, p_val);
+  List_copyRange(res, index + 1, p_target, index, p_target->len - index);
 
   return res;
 }
 
 // delete item from list
 List *List_delete(List *p_target, int index) {
-  List *res = (List *) malloc(sizeof(List));
-  res->vals = (Generic **) malloc(sizeof(Generic *) * (p_target->len - 1));
-  res->len = p_target->len - 1;
+  List *res = List_alloc(p_target->storage, p_target->len - 1);
 
-  // resIndex is the index in the resulting list
-  // targetIndex is the index in the provided list
-  int resIndex = 0;
-  for (int targetIndex = 0; targetIndex < p_target->len; targetIndex += 1) {
-    if (targetIndex == index) continue;
-    res->vals[resIndex] = Generic_copy(p_target->vals[targetIndex]);
-    resIndex += 1;
-  }
+  List_copyRange(res, 0, p_target, 0, index);
+  List_copyRange(res, index, p_target, index + 1, p_target->len - index - 1);
 
   return res;
 }
 
 // free list
 void List_free(List *p_target) {
-  for (int i = 0; i < p_target->len; i += 1) {
-    Generic_free(p_target->vals[i]);
+  if (p_target->storage == LIST_BOXED) {
+    for (int i = 0; i < p_target->len; i += 1) {
+      Generic_free(p_target->vals[i]);
+    }
   }
 
   free(p_target->vals);
+  free(p_target->ints);
+  free(p_target->floats);
   free(p_target);
 }
 
 // joins all lists into a single one, and returns
 List *List_join(List *lists[], int count) {
-  List *res = (List *) malloc(sizeof(List));
-  res->len = 0;
+  int length = 0;
+
+  // empty lists do not affect storage
+  enum ListStorage storage = LIST_BOXED;
+  bool foundItems = false;
 
   for (int i = 0; i < count; i += 1) {
-    res->len += lists[i]->len;
+    length += lists[i]->len;
+    if (lists[i]->len == 0) continue;
+
+    storage = foundItems ? mergeStorage(storage, lists[i]->storage) : lists[i]->storage;
+    foundItems = true;
   }
 
-  res->vals = (Generic **) malloc(sizeof(Generic *) * res->len);
-  
+  List *res = List_alloc(storage, length);
+
   int i = 0;
   for (int listIndex = 0; listIndex < count; listIndex += 1) {
-    for (int itemIndex = 0; itemIndex < lists[listIndex]->len; itemIndex += 1) {
-      res->vals[i] = Generic_copy(lists[listIndex]->vals[itemIndex]);
-      i += 1;
-    }
+    List_copyRange(res, i, lists[listIndex], 0, lists[listIndex]->len);
+    i += lists[listIndex]->len;
   }
 
   return res;
@@ -112,30 +244,22 @@ List *List_join(List *lists[], int count) {
 
 // returns the sublist from index1 to index2
 List *List_sublist(List *p_target, int index1, int index2) {
-  List *res = (List *) malloc(sizeof(List));
-  res->vals = (Generic **) malloc(sizeof(Generic *) * (index2 - index1));
-  res->len = index2 - index1;
-  
-  for (int i = index1; i < index2; i += 1) {
-    res->vals[i - index1] = Generic_copy(p_target->vals[i]);
-  }
-
+  List *res = List_alloc(p_target->storage, index2 - index1);
+  List_copyRange(res, 0, p_target, index1, index2 - index1);
   return res;
 }
 
 // set item in list
 List *List_set(List *p_target, Generic *p_val, int index) {
-  List *res = (List *) malloc(sizeof(List));
-  res->vals = (Generic **) malloc(sizeof(Generic *) * p_target->len);
-  res->len = p_target->len;
-  
-  for (int i = 0; i < res->len; i += 1) {
-    if (i != index) {
-      res->vals[i] = Generic_copy(p_target->vals[i]);
-    } else {
-      res->vals[i] = Generic_copy(p_val);
-    }
-  }
+  enum ListStorage storage = p_target->len == 1
+    ? getItemStorage(p_val)
+    : mergeStorage(p_target->storage, getItemStorage(p_val));
+
+  List *res = List_alloc(storage, p_target->len);
+
+  List_copyRange(res, 0, p_target, 0, index);
+  List_write(res, index, p_val);
+  List_copyRange(res, index + 1, p_target, index + 1, p_target->len - index - 1);
 
   return res;
 }
@@ -147,29 +271,92 @@ int List_length(List *p_target) {
 
 // delete multiple items from list from index1 to index2
 List *List_deleteMultiple(List *p_target, int index1, int index2) {
-  List *res = (List *) malloc(sizeof(List));
-  res->len = p_target->len - index2 + index1;
-  res->vals = (Generic **) malloc(sizeof(Generic *) * (res->len));
+  List *res = List_alloc(p_target->storage, p_target->len - index2 + index1);
 
-  for (int i = 0; i < index1; i += 1) {
-    res->vals[i] = Generic_copy(p_target->vals[i]);
-  }
+  List_copyRange(res, 0, p_target, 0, index1);
+  List_copyRange(res, index1, p_target, index2, p_target->len - index2);
+
+  return res;
+}
+
+// returns 1 if the item at index in p_target is the same as p_val, else returns 0
+// follows the same rules as Generic_is, without boxing packed items
+int List_itemIs(List *p_target, int index, Generic *p_val) {
+  if (p_target->storage == LIST_BOXED) return Generic_is(p_target->vals[index], p_val);
+
+  // packed items are numbers, so only numerical equality applies
+  if (p_val->type == TYPE_INT) return List_numberAt(p_target, index) == *((int *) p_val->p_val);
+  if (p_val->type == TYPE_FLOAT) return List_numberAt(p_target, index) == *((double *) p_val->p_val);
+  return 0;
+}
+
+// returns a structural hash of the list, combining the hashes of every item
+// packed and boxed lists with the same items hash the same
+unsigned int List_hash(List *p_target) {
+  unsigned int res = 2166136261u ^ (unsigned int) p_target->len;
+
+  for (int i = 0; i < p_target->len; i += 1) {
+    unsigned int itemHash;
 
-  for (int i = index2; i < p_target->len; i += 1) {
-    res->vals[i - index2 + index1] = Generic_copy(p_target->vals[i]);
+    if (p_target->storage == LIST_INT) itemHash = hashNumber(p_target->ints[i]);
+    else if (p_target->storage == LIST_FLOAT) itemHash = hashNumber(p_target->floats[i]);
+    else itemHash = Generic_hash(p_target->vals[i]);
+
+    res = (res ^ itemHash) * 16777619u;
   }
 
   return res;
 }
 
+// returns the index of the first item in p_target which is the same as p_val, or -1 if not found
+int List_find(List *p_target, Generic *p_val) {
+  if (p_target->storage == LIST_INT && p_val->type == TYPE_INT) {
+    // fast path, scan packed ints directly
+    int val = *((int *) p_val->p_val);
+    for (int i = 0; i < p_target->len; i += 1) {
+      if (p_target->ints[i] == val) return i;
+    }
+
+    return -1;
+  }
+
+  if (p_target->storage == LIST_BOXED && (p_val->type == TYPE_LIST || p_val->type == TYPE_STRING)) {
+    // compare hashes first, so that mismatches are rejected without a deep comparison
+    // item hashes stay cached in the list, which makes repeated searches through the same list cheap
+    unsigned int hash = Generic_hash(p_val);
+    for (int i = 0; i < p_target->len; i += 1) {
+      if (Generic_hash(p_target->vals[i]) == hash && Generic_is(p_target->vals[i], p_val)) return i;
+    }
+
+    return -1;
+  }
+
+  for (int i = 0; i < p_target->len; i += 1) {
+    if (List_itemIs(p_target, i, p_val)) return i;
+  }
+
+  return -1;
+}
+
 int List_compare(List *p_target1, List *p_target2) {
 
   // Early check on length.
   if (p_target1->len != p_target2->len) return 0;
+  if (p_target1->len == 0) return 1;
+
+  if (p_target1->storage == LIST_INT && p_target2->storage == LIST_INT) {
+    return memcmp(p_target1->ints, p_target2->ints, sizeof(int) * p_target1->len) == 0;
+  }
 
   for(int i = 0; i < p_target1->len; i += 1) {
-    if (!Generic_is(p_target1->vals[i], p_target2->vals[i])) return 0;
+    int same;
+
+    if (p_target1->storage == LIST_BOXED) same = List_itemIs(p_target2, i, p_target1->vals[i]);
+    else if (p_target2->storage == LIST_BOXED) same = List_itemIs(p_target1, i, p_target2->vals[i]);
+    else same = List_numberAt(p_target1, i) == List_numberAt(p_target2, i);
+
+    if (!same) return 0;
   }
 
   return 1;
-}
\ No newline at end of file
+}
@@ -2,17 +2,36 @@
 #define LIST_H
 #include "generic.h"
 
+// how the items of a list are stored
+// lists where every item is an integer (or every item is a float) are stored unboxed, in a packed array
+// all other lists are stored as an array of generics
+enum ListStorage {
+  LIST_BOXED,
+  LIST_INT,
+  LIST_FLOAT
+};
+
 // list container
+// only the array corresponding to storage is allocated, the others are NULL
 typedef struct List {
+  enum ListStorage storage;
   Generic **vals;
+  int *ints;
+  double *floats;
   int len;
 } List;
 
 // prototypes
+enum ListStorage getItemStorage(Generic *);
 void List_print(List *);
+List *List_alloc(enum ListStorage, int);
 List *List_new(Generic **, int);
+List *List_wrap(Generic **, int);
 List *List_copy(List *);
+List *List_pack(List *);
+List *List_toFloats(List *);
 Generic *List_get(List *, int);
+void List_copyRange(List *, int, List *, int, int);
 List *List_insert(List *, Generic *, int);
 List *List_delete(List *, int);
 void List_free(List *);
@@ -21,6 +40,9 @@ List *List_sublist(List *, int, int);
 int List_length(List *);
 List *List_set(List *, Generic *, int);
 List *List_deleteMultiple(List *, int, int);
+int List_itemIs(List *, int, Generic *);
+unsigned int List_hash(List *);
+int List_find(List *, Generic *);
 int List_compare(List *, List *);
 
-#endif
\ No newline at end of file
+#endif
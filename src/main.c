@@ -101,12 +101,6 @@ int main(int argc, char *argv[]) {
 
   // Calculate the number of arguments to skip (ie. name of executable, file passed).
   int argsToSkip = 1 + (pipedInput ? 0 : 1) + (debug ? 1 : 0);
-  int exitCode = run(code, fileLength, argc - argsToSkip, &argv[argsToSkip], debug);
-
-  // free code
-  free(code);
-  code = NULL;
-  if (debug) printf("Code Freed\n");
-
-  return exitCode;
+  // run frees code once it is parsed
+  return run(code, fileLength, argc - argsToSkip, &argv[argsToSkip], debug, true);
 }
\ No newline at end of file
@@ -0,0 +1,362 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include "map.h"
+#include "generic.h"
+#include "list.h"
+
+// bits of the hash consumed by each level of the trie
+#define MAP_BITS 5
+#define MAP_MASK 31
+
+/* nodes */
+// allocates a leaf with room for count pairs, all with the given hash
+MapNode *MapNode_newLeaf(unsigned int hash, int count) {
+  MapNode *res = (MapNode *) malloc(sizeof(MapNode));
+  res->refCount = 1;
+  res->isLeaf = true;
+  res->count = count;
+  res->bitmap = 0;
+  res->hash = hash;
+  res->children = NULL;
+  res->keys = (Generic **) malloc(sizeof(Generic *) * count);
+  res->vals = (Generic **) malloc(sizeof(Generic *) * count);
+  return res;
+}
+
+// allocates a branch with room for count children
+MapNode *MapNode_newBranch(unsigned int bitmap, int count) {
+  MapNode *res = (MapNode *) malloc(sizeof(MapNode));
+  res->refCount = 1;
+  res->isLeaf = false;
+  res->count = count;
+  res->bitmap = bitmap;
+  res->hash = 0;
+  res->children = (MapNode **) malloc(sizeof(MapNode *) * count);
+  res->keys = NULL;
+  res->vals = NULL;
+  return res;
+}
+
+// adds a reference to a node
+// nodes can be shared by maps on different threads (see pmap), so references are counted atomically
+void MapNode_retain(MapNode *p_node) {
+  __atomic_add_fetch(&p_node->refCount, 1, __ATOMIC_RELAXED);
+}
+
+// drops a reference to a node, freeing it (and releasing its children) once unreferenced
+void MapNode_release(MapNode *p_node) {
+  if (p_node == NULL) return;
+  if (__atomic_sub_fetch(&p_node->refCount, 1, __ATOMIC_ACQ_REL) > 0) return;
+
+  if (p_node->isLeaf) {
+    for (int i = 0; i < p_node->count; i++) {
+      Generic_free(p_node->keys[i]);
+      Generic_free(p_node->vals[i]);
+    }
+  } else {
+    for (int i = 0; i < p_node->count; i++) MapNode_release(p_node->children[i]);
+  }
+
+  free(p_node->children);
+  free(p_node->keys);
+  free(p_node->vals);
+  free(p_node);
+}
+
+// returns the index of the child for slot in a branch
+int MapNode_index(MapNode *p_node, unsigned int slot) {
+  return __builtin_popcount(p_node->bitmap & ((1u << slot) - 1));
+}
+
+// creates a branch at shift holding two leaves with different hashes, nesting further if they share a slot
+// takes ownership of both leaves
+MapNode *MapNode_merge(MapNode *p_leaf1, MapNode *p_leaf2, int shift) {
+  unsigned int slot1 = (p_leaf1->hash >> shift) & MAP_MASK;
+  unsigned int slot2 = (p_leaf2->hash >> shift) & MAP_MASK;
+
+  if (slot1 == slot2) {
+    MapNode *res = MapNode_newBranch(1u << slot1, 1);
+    res->children[0] = MapNode_merge(p_leaf1, p_leaf2, shift + MAP_BITS);
+    return res;
+  }
+
+  MapNode *res = MapNode_newBranch((1u << slot1) | (1u << slot2), 2);
+  res->children[slot1 < slot2 ? 0 : 1] = p_leaf1;
+  res->children[slot1 < slot2 ? 1 : 0] = p_leaf2;
+  return res;
+}
+
+// returns a new node, equivalent to p_node with key set to val
+// p_node is left untouched, and shares everything off the path to key with the result
+// sets *p_added if key was not previously in p_node
+MapNode *MapNode_set(MapNode *p_node, unsigned int hash, int shift, Generic *p_key, Generic *p_val, bool *p_added) {
+  if (p_node == NULL) {
+    MapNode *res = MapNode_newLeaf(hash, 1);
+    res->keys[0] = Generic_copy(p_key);
+    res->vals[0] = Generic_copy(p_val);
+    *p_added = true;
+    return res;
+  }
+
+  if (p_node->isLeaf) {
+    if (p_node->hash != hash) {
+      // different key, split into a branch
+      MapNode_retain(p_node);
+      return MapNode_merge(p_node, MapNode_set(NULL, hash, shift, p_key, p_val, p_added), shift);
+    }
+
+    // same hash, replace the pair with an equal key, or add to the end
+    int index = p_node->count;
+    for (int i = 0; i < p_node->count; i++) {
+      if (Generic_is(p_node->keys[i], p_key)) index = i;
+    }
+
+    *p_added = index == p_node->count;
+    MapNode *res = MapNode_newLeaf(hash, p_node->count + (*p_added ? 1 : 0));
+
+    for (int i = 0; i < p_node->count; i++) {
+      res->keys[i] = Generic_copy(p_node->keys[i]);
+      res->vals[i] = i == index ? Generic_copy(p_val) : Generic_copy(p_node->vals[i]);
+    }
+
+    if (*p_added) {
+      res->keys[index] = Generic_copy(p_key);
+      res->vals[index] = Generic_copy(p_val);
+    }
+
+    return res;
+  }
+
+  // branch case
+  unsigned int slot = (hash >> shift) & MAP_MASK;
+  int index = MapNode_index(p_node, slot);
+  bool exists = (p_node->bitmap & (1u << slot)) != 0;
+
+  MapNode *res = MapNode_newBranch(p_node->bitmap | (1u << slot), p_node->count + (exists ? 0 : 1));
+
+  // share the children before and after index
+  for (int i = 0; i < index; i++) {
+    res->children[i] = p_node->children[i];
+    MapNode_retain(res->children[i]);
+  }
+
+  for (int i = exists ? index + 1 : index; i < p_node->count; i++) {
+    res->children[exists ? i : i + 1] = p_node->children[i];
+    MapNode_retain(p_node->children[i]);
+  }
+
+  res->children[index] = MapNode_set(exists ? p_node->children[index] : NULL, hash, shift + MAP_BITS, p_key, p_val, p_added);
+  return res;
+}
+
+// returns a new node, equivalent to p_node without key, or NULL if nothing is left
+// key must be present in p_node
+MapNode *MapNode_delete(MapNode *p_node, unsigned int hash, int shift, Generic *p_key) {
+  if (p_node->isLeaf) {
+    if (p_node->count == 1) return NULL;
+
+    MapNode *res = MapNode_newLeaf(hash, p_node->count - 1);
+
+    int resIndex = 0;
+    for (int i = 0; i < p_node->count; i++) {
+      if (Generic_is(p_node->keys[i], p_key)) continue;
+      res->keys[resIndex] = Generic_copy(p_node->keys[i]);
+      res->vals[resIndex] = Generic_copy(p_node->vals[i]);
+      resIndex++;
+    }
+
+    return res;
+  }
+
+  // branch case
+  unsigned int slot = (hash >> shift) & MAP_MASK;
+  int index = MapNode_index(p_node, slot);
+  MapNode *p_child = MapNode_delete(p_node->children[index], hash, shift + MAP_BITS, p_key);
+
+  if (p_node->count == 1 && (p_child == NULL || p_child->isLeaf)) return p_child;
+
+  // collapse a branch left with a single leaf into that leaf
+  if (p_child == NULL && p_node->count == 2 && p_node->children[1 - index]->isLeaf) {
+    MapNode_retain(p_node->children[1 - index]);
+    return p_node->children[1 - index];
+  }
+
+  MapNode *res = MapNode_newBranch(
+    p_child == NULL ? p_node->bitmap & ~(1u << slot) : p_node->bitmap,
+    p_child == NULL ? p_node->count - 1 : p_node->count
+  );
+
+  int resIndex = 0;
+  for (int i = 0; i < p_node->count; i++) {
+    if (i == index) {
+      if (p_child != NULL) res->children[resIndex++] = p_child;
+      continue;
+    }
+
+    res->children[resIndex] = p_node->children[i];
+    MapNode_retain(res->children[resIndex]);
+    resIndex++;
+  }
+
+  return res;
+}
+
+// calls cb on every key value pair under p_node
+// stops and returns false if cb returns false
+bool MapNode_forEach(MapNode *p_node, bool (*cb)(Generic *, Generic *, void *), void *p_data) {
+  if (p_node == NULL) return true;
+
+  for (int i = 0; i < p_node->count; i++) {
+    bool cont = p_node->isLeaf
+      ? cb(p_node->keys[i], p_node->vals[i], p_data)
+      : MapNode_forEach(p_node->children[i], cb, p_data);
+
+    if (!cont) return false;
+  }
+
+  return true;
+}
+
+/* maps */
+// creates a new empty map
+Map *Map_new() {
+  Map *res = (Map *) malloc(sizeof(Map));
+  res->p_root = NULL;
+  res->len = 0;
+  return res;
+}
+
+// copy a given map, sharing its nodes
+Map *Map_copy(Map *p_target) {
+  Map *res = Map_new();
+  res->p_root = p_target->p_root;
+  res->len = p_target->len;
+  if (res->p_root != NULL) MapNode_retain(res->p_root);
+  return res;
+}
+
+// free map
+void Map_free(Map *p_target) {
+  MapNode_release(p_target->p_root);
+  free(p_target);
+}
+
+// print a single pair, used by Map_print
+bool printPair(Generic *p_key, Generic *p_val, void *p_data) {
+  bool *p_first = (bool *) p_data;
+  if (!*p_first) printf(", ");
+  *p_first = false;
+
+  Generic_print(p_key);
+  printf(": ");
+  Generic_print(p_val);
+  return true;
+}
+
+void Map_print(Map *p_target) {
+  bool first = true;
+
+  printf("[Map: ");
+  MapNode_forEach(p_target->p_root, printPair, &first);
+  printf("]");
+}
+
+// returns the value stored at key, or NULL if key is not in the map
+// the value still belongs to the map
+Generic *Map_get(Map *p_target, Generic *p_key) {
+  unsigned int hash = Generic_hash(p_key);
+  MapNode *p_curr = p_target->p_root;
+  int shift = 0;
+
+  while (p_curr != NULL) {
+    if (p_curr->isLeaf) {
+      if (p_curr->hash != hash) return NULL;
+
+      for (int i = 0; i < p_curr->count; i++) {
+        if (Generic_is(p_curr->keys[i], p_key)) return p_curr->vals[i];
+      }
+
+      return NULL;
+    }
+
+    unsigned int slot = (hash >> shift) & MAP_MASK;
+    if ((p_curr->bitmap & (1u << slot)) == 0) return NULL;
+
+    p_curr = p_curr->children[MapNode_index(p_curr, slot)];
+    shift += MAP_BITS;
+  }
+
+  return NULL;
+}
+
+// returns a new map, with key set to val
+Map *Map_set(Map *p_target, Generic *p_key, Generic *p_val) {
+  bool added = false;
+
+  Map *res = Map_new();
+  res->p_root = MapNode_set(p_target->p_root, Generic_hash(p_key), 0, p_key, p_val, &added);
+  res->len = p_target->len + (added ? 1 : 0);
+  return res;
+}
+
+// returns a new map, without key
+Map *Map_delete(Map *p_target, Generic *p_key) {
+  if (Map_get(p_target, p_key) == NULL) return Map_copy(p_target);
+
+  Map *res = Map_new();
+  res->p_root = MapNode_delete(p_target->p_root, Generic_hash(p_key), 0, p_key);
+  res->len = p_target->len - 1;
+  return res;
+}
+
+// collect a single key, used by Map_keys
+bool collectKey(Generic *p_key, Generic *p_val, void *p_data) {
+  Generic ***p_p_curr = (Generic ***) p_data;
+  **p_p_curr = Generic_copy(p_key);
+  (*p_p_curr)++;
+  return true;
+}
+
+// returns a list of every key in the map
+List *Map_keys(Map *p_target) {
+  Generic **keys = (Generic **) malloc(sizeof(Generic *) * p_target->len);
+  Generic **p_curr = keys;
+
+  MapNode_forEach(p_target->p_root, collectKey, &p_curr);
+  return List_wrap(keys, p_target->len);
+}
+
+// get number of keys in map
+int Map_length(Map *p_target) {
+  return p_target->len;
+}
+
+// add the hash of a single pair, used by Map_hash
+// pairs are summed, so that the hash does not depend on the layout of the trie
+bool hashPair(Generic *p_key, Generic *p_val, void *p_data) {
+  unsigned int *p_res = (unsigned int *) p_data;
+  *p_res += (Generic_hash(p_key) * 16777619u) ^ Generic_hash(p_val);
+  return true;
+}
+
+// returns a structural hash of the map
+unsigned int Map_hash(Map *p_target) {
+  unsigned int res = 2166136261u ^ (unsigned int) p_target->len;
+  MapNode_forEach(p_target->p_root, hashPair, &res);
+  return res;
+}
+
+// check a single pair is in another map, used by Map_compare
+bool pairIn(Generic *p_key, Generic *p_val, void *p_data) {
+  Generic *p_other = Map_get((Map *) p_data, p_key);
+  return p_other != NULL && Generic_is(p_val, p_other);
+}
+
+// returns 1 if both maps have the same keys, with the same values, else returns 0
+int Map_compare(Map *p_target1, Map *p_target2) {
+  if (p_target1->len != p_target2->len) return 0;
+  if (p_target1->p_root == p_target2->p_root) return 1;
+
+  return MapNode_forEach(p_target1->p_root, pairIn, p_target2);
+}
@@ -0,0 +1,42 @@
+#ifndef MAP_H
+#define MAP_H
+#include <stdbool.h>
+#include "generic.h"
+#include "list.h"
+
+// node in a hash array mapped trie
+// nodes are immutable once built, and shared between maps using refCount
+// a branch holds up to 32 children, indexed by 5 bits of the hash at each level (bitmap marks which are present)
+// a leaf holds every key value pair with the same hash (almost always a single pair)
+typedef struct MapNode {
+  int refCount;
+  bool isLeaf;
+  int count;
+  unsigned int bitmap;
+  unsigned int hash;
+  struct MapNode **children;
+  Generic **keys;
+  Generic **vals;
+} MapNode;
+
+// map container
+// setting or deleting a key returns a new map, sharing all untouched nodes with the original
+typedef struct Map {
+  MapNode *p_root;
+  int len;
+} Map;
+
+// prototypes
+Map *Map_new();
+Map *Map_copy(Map *);
+void Map_free(Map *);
+void Map_print(Map *);
+Generic *Map_get(Map *, Generic *);
+Map *Map_set(Map *, Generic *, Generic *);
+Map *Map_delete(Map *, Generic *);
+List *Map_keys(Map *);
+int Map_length(Map *);
+unsigned int Map_hash(Map *);
+int Map_compare(Map *, Map *);
+
+#endif
@@ -0,0 +1,257 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include "memo.h"
+#include "generic.h"
+#include "list.h"
+#include "map.h"
+#include "scope.h"
+#include "stdlib.h"
+
+// creates a memo of p_func, caching up to capacity results
+Memo *Memo_new(Generic *p_func, int capacity) {
+  Memo *res = (Memo *) malloc(sizeof(Memo));
+  res->refCount = 1;
+
+  // hold a copy of the function, so that applyFunc does not free it
+  res->p_func = Generic_copy(p_func);
+  res->p_func->refCount++;
+
+  res->capacity = capacity;
+  res->size = 0;
+
+  // a power of 2 number of buckets, at least one per entry
+  res->bucketCount = 1;
+  while (res->bucketCount < capacity) res->bucketCount *= 2;
+  res->buckets = (MemoEntry **) calloc(res->bucketCount, sizeof(MemoEntry *));
+
+  res->p_newest = NULL;
+  res->p_oldest = NULL;
+  res->hits = 0;
+  res->misses = 0;
+  pthread_mutex_init(&res->lock, NULL);
+
+  return res;
+}
+
+// memos are shared between every generic (and thread) that holds them
+Memo *Memo_copy(Memo *p_target) {
+  __atomic_add_fetch(&p_target->refCount, 1, __ATOMIC_RELAXED);
+  return p_target;
+}
+
+// frees an entry, and the arguments and result it holds
+void MemoEntry_free(MemoEntry *p_entry) {
+  for (int i = 0; i < p_entry->argCount; i++) Generic_free(p_entry->args[i]);
+  Generic_free(p_entry->p_res);
+  free(p_entry->args);
+  free(p_entry);
+}
+
+// drops a reference to a memo, freeing it and its cache once unreferenced
+void Memo_free(Memo *p_target) {
+  if (__atomic_sub_fetch(&p_target->refCount, 1, __ATOMIC_ACQ_REL) > 0) return;
+
+  MemoEntry *p_curr = p_target->p_newest;
+  while (p_curr != NULL) {
+    MemoEntry *p_tmp = p_curr;
+    p_curr = p_curr->p_older;
+    MemoEntry_free(p_tmp);
+  }
+
+  Generic_free(p_target->p_func);
+  pthread_mutex_destroy(&p_target->lock);
+  free(p_target->buckets);
+  free(p_target);
+}
+
+bool isSameArg(Generic *, Generic *);
+
+// returns true if two lists hold the same items, of the same types (see isSameArg)
+bool isSameList(List *p_a, List *p_b) {
+  if (p_a->len != p_b->len) return false;
+  if (p_a->len == 0) return true;
+
+  if (p_a->storage == LIST_INT && p_b->storage == LIST_INT) {
+    return memcmp(p_a->ints, p_b->ints, sizeof(int) * p_a->len) == 0;
+  }
+  if (p_a->storage == LIST_FLOAT && p_b->storage == LIST_FLOAT) {
+    return memcmp(p_a->floats, p_b->floats, sizeof(double) * p_a->len) == 0;
+  }
+
+  for (int i = 0; i < p_a->len; i++) {
+    if (p_a->storage == LIST_BOXED && p_b->storage == LIST_BOXED) {
+      if (!isSameArg(p_a->vals[i], p_b->vals[i])) return false;
+      continue;
+    }
+
+    // packed items are boxed to be compared
+    Generic *p_itemA = List_get(p_a, i);
+    Generic *p_itemB = List_get(p_b, i);
+    bool same = isSameArg(p_itemA, p_itemB);
+    Generic_free(p_itemA);
+    Generic_free(p_itemB);
+
+    if (!same) return false;
+  }
+
+  return true;
+}
+
+// returns true if two maps hold the same keys and values, of the same types (see isSameArg)
+bool isSameMap(Map *p_a, Map *p_b) {
+  if (!Map_compare(p_a, p_b)) return false;
+
+  List *p_keysA = Map_keys(p_a);
+  List *p_keysB = Map_keys(p_b);
+  bool same = isSameList(p_keysA, p_keysB);
+
+  for (int i = 0; same && i < p_keysA->len; i++) {
+    Generic *p_key = List_get(p_keysA, i);
+    same = isSameArg(Map_get(p_a, p_key), Map_get(p_b, p_key));
+    Generic_free(p_key);
+  }
+
+  List_free(p_keysA);
+  List_free(p_keysB);
+  return same;
+}
+
+// returns true if a and b are the same argument
+// stricter than Generic_is, as (is 1 1.0) is true, but a function can return different results for them
+// so types must match (inside lists and maps too), and floats must have the same bits (0.0 is not -0.0)
+bool isSameArg(Generic *a, Generic *b) {
+  if (a->type != b->type) return false;
+
+  switch (a->type) {
+    case TYPE_FLOAT:
+      return memcmp(a->p_val, b->p_val, sizeof(double)) == 0;
+    case TYPE_LIST:
+      return a == b || isSameList((List *) a->p_val, (List *) b->p_val);
+    case TYPE_MAP:
+      return a == b || isSameMap((Map *) a->p_val, (Map *) b->p_val);
+    default:
+      return Generic_is(a, b);
+  }
+}
+
+// hashes a list of arguments, such that calls with the same arguments (using isSameArg) have the same hash
+unsigned int hashArgs(Generic *args[], int length) {
+  unsigned int res = 2166136261u ^ (unsigned int) length;
+  for (int i = 0; i < length; i++) res = (res * 16777619u) ^ (Generic_hash(args[i]) + (unsigned int) args[i]->type);
+  return res;
+}
+
+// returns the entry for a call with args, or NULL if it is not cached
+MemoEntry *findEntry(Memo *p_memo, unsigned int hash, Generic *args[], int length) {
+  MemoEntry *p_curr = p_memo->buckets[hash & (p_memo->bucketCount - 1)];
+
+  for (; p_curr != NULL; p_curr = p_curr->p_nextInBucket) {
+    if (p_curr->hash != hash || p_curr->argCount != length) continue;
+
+    bool same = true;
+    for (int i = 0; i < length && same; i++) same = isSameArg(p_curr->args[i], args[i]);
+    if (same) return p_curr;
+  }
+
+  return NULL;
+}
+
+// removes an entry from the order of use
+void unlinkEntry(Memo *p_memo, MemoEntry *p_entry) {
+  if (p_entry->p_newer != NULL) p_entry->p_newer->p_older = p_entry->p_older;
+  else p_memo->p_newest = p_entry->p_older;
+
+  if (p_entry->p_older != NULL) p_entry->p_older->p_newer = p_entry->p_newer;
+  else p_memo->p_oldest = p_entry->p_newer;
+}
+
+// makes an entry the most recently used
+void pushEntry(Memo *p_memo, MemoEntry *p_entry) {
+  p_entry->p_newer = NULL;
+  p_entry->p_older = p_memo->p_newest;
+
+  if (p_memo->p_newest != NULL) p_memo->p_newest->p_newer = p_entry;
+  else p_memo->p_oldest = p_entry;
+
+  p_memo->p_newest = p_entry;
+}
+
+// drops the least recently used entry
+void evictOldest(Memo *p_memo) {
+  MemoEntry *p_entry = p_memo->p_oldest;
+  unlinkEntry(p_memo, p_entry);
+
+  // remove from bucket
+  MemoEntry **p_p_curr = &p_memo->buckets[p_entry->hash & (p_memo->bucketCount - 1)];
+  while (*p_p_curr != p_entry) p_p_curr = &((*p_p_curr)->p_nextInBucket);
+  *p_p_curr = p_entry->p_nextInBucket;
+
+  MemoEntry_free(p_entry);
+  p_memo->size--;
+}
+
+// calls the memoized function with args, or returns a copy of the cached result
+// like applyFunc, args which are not referenced elsewhere (refCount of 0) are freed
+Generic *Memo_apply(Memo *p_memo, Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  unsigned int hash = hashArgs(args, length);
+
+  pthread_mutex_lock(&p_memo->lock);
+  MemoEntry *p_entry = findEntry(p_memo, hash, args, length);
+
+  if (p_entry != NULL) {
+    // hit, move to front
+    p_memo->hits++;
+    unlinkEntry(p_memo, p_entry);
+    pushEntry(p_memo, p_entry);
+
+    Generic *res = Generic_copy(p_entry->p_res);
+    pthread_mutex_unlock(&p_memo->lock);
+
+    for (int i = 0; i < length; i++) {
+      if (args[i]->refCount == 0) Generic_free(args[i]);
+    }
+
+    return res;
+  }
+
+  p_memo->misses++;
+  pthread_mutex_unlock(&p_memo->lock);
+
+  // copy the arguments to key the result by, as applyFunc may free them
+  Generic **keys = (Generic **) malloc(sizeof(Generic *) * (length > 0 ? length : 1));
+  for (int i = 0; i < length; i++) keys[i] = Generic_copy(args[i]);
+
+  // the lock is not held while calling, as the function may call itself
+  Generic *res = applyFunc(p_memo->p_func, p_scope, args, length, lineNumber);
+
+  pthread_mutex_lock(&p_memo->lock);
+
+  // another call (ie. on another thread) may have cached the same arguments in the meantime
+  if (findEntry(p_memo, hash, keys, length) != NULL) {
+    pthread_mutex_unlock(&p_memo->lock);
+
+    for (int i = 0; i < length; i++) Generic_free(keys[i]);
+    free(keys);
+    return res;
+  }
+
+  p_entry = (MemoEntry *) malloc(sizeof(MemoEntry));
+  p_entry->hash = hash;
+  p_entry->argCount = length;
+  p_entry->args = keys;
+  p_entry->p_res = Generic_copy(res);
+
+  MemoEntry **p_bucket = &p_memo->buckets[hash & (p_memo->bucketCount - 1)];
+  p_entry->p_nextInBucket = *p_bucket;
+  *p_bucket = p_entry;
+  pushEntry(p_memo, p_entry);
+
+  p_memo->size++;
+  if (p_memo->size > p_memo->capacity) evictOldest(p_memo);
+
+  pthread_mutex_unlock(&p_memo->lock);
+  return res;
+}
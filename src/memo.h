@@ -0,0 +1,43 @@
+#ifndef MEMO_H
+#define MEMO_H
+#include <pthread.h>
+#include "generic.h"
+#include "scope.h"
+
+// a cached call, keyed by the arguments it was called with
+// entries are chained in their hash bucket (p_nextInBucket), and in order of use (p_newer, p_older)
+typedef struct MemoEntry {
+  unsigned int hash;
+  int argCount;
+  Generic **args;
+  Generic *p_res;
+  struct MemoEntry *p_nextInBucket;
+  struct MemoEntry *p_newer;
+  struct MemoEntry *p_older;
+} MemoEntry;
+
+// memoized function, with a cache of up to capacity results
+// once full, the least recently used result is dropped
+// memos are shared between generics (and threads) using refCount, so recursive calls use the same cache
+// lock guards the cache and counters, it is never held while p_func runs
+typedef struct Memo {
+  int refCount;
+  Generic *p_func;
+  int capacity;
+  int size;
+  int bucketCount;
+  MemoEntry **buckets;
+  MemoEntry *p_newest;
+  MemoEntry *p_oldest;
+  long hits;
+  long misses;
+  pthread_mutex_t lock;
+} Memo;
+
+// prototypes
+Memo *Memo_new(Generic *, int);
+Memo *Memo_copy(Memo *);
+void Memo_free(Memo *);
+Generic *Memo_apply(Memo *, Scope *, Generic *[], int, int);
+
+#endif
@@ -1,279 +1,167 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "parse.h"
 #include "ast.h"
 #include "tokens.h"
+#include "lex.h"
+#include "pool.h"
+#include "vector.h"
+#include "symbol.h"
 
-// skips closure, such as function or application
-// particulary useful for parsing statement
-// p_p_curr is the pointer to the pointer to the token containing the open of the closure ("(" or "{")
-// open and close are the respective token types designating the open and close types
-// p_index is a pointer to the loop itterating over the tokens
-// length is the length of the parent expression
-void skipClosure(int *p_index, Token **p_p_curr, enum TokenType open, enum TokenType close, int length) {
-  int depth = 1;
-
-  // until depth == 0 (we are out of the application), loop
-  while (depth != 0 && *p_index < length) {
-    *p_p_curr = (*p_p_curr)->p_next;
-    (*p_index)++;
-
-    // throw bug if we reach the end of a file
-    if ((*p_p_curr)->type == TOK_END) {
-      printf(
-        "Syntax Error @ Line %i: Unexpected %s token.\n", 
-        (*p_p_curr)->lineNumber, getTokenTypeString((*p_p_curr)->type)
-      );
-      exit(0);
-    }
+// code is only split into chunks of at least this many chars (see parseCode)
+#define PARSE_CHUNK_MIN_SIZE (256 * 1024)
+
+// the parser is recursive descent, pulling tokens from a lexer (see Lexer_peek) as it needs them
+// every parse function consumes the tokens of what it parses, leaving the lexer on the token after it
+// so each token is read once, no matter how deeply code is nested
 
-    if ((*p_p_curr)->type == close) depth--;
-    else if ((*p_p_curr)->type == open) depth++;
+// creates an ast node with the value of a token
+AstNode *newTokenNode(Token *p_token, enum Opcodes opcode) {
+  AstNode *res = AstNode_new(NULL, opcode, p_token->lineNumber);
+
+  // identifiers are interned, so that each name is held once
+  if (opcode == OP_IDENTIFIER) {
+    res->val = Symbol_intern(p_token->val, p_token->length);
+    return res;
   }
+
+  // other token values are slices, so they are copied into a new string
+  res->val = (char *) malloc(sizeof(char) * (p_token->length + 1));
+  memcpy(res->val, p_token->val, p_token->length);
+  res->val[p_token->length] = '\0';
+
+  return res;
+}
+
+// throws an error for a token which cannot appear where it was found
+void handleUnexpectedToken(Token *p_token) {
+  jumpOnSyntaxError();
+  printf(
+    "Syntax Error @ Line %i: Unexpected %s token.\n",
+    p_token->lineNumber, getTokenTypeString(p_token->type)
+  );
+  exit(0);
 }
 
 // parse application
 // ebnf: application = "(", {value}, ")";
-AstNode *parseApplication(Token *p_head, int length) {
+AstNode *parseApplication(Lexer *p_lexer) {
+  Token *p_head = Lexer_peek(p_lexer, 0);
+
   if (p_head->type != TOK_APPLYOPEN) {
     // error handling for invalid first token
-    printf(
-      "Syntax Error @ Line %i: Unexpected %s token.\n", 
-      p_head->lineNumber, getTokenTypeString(p_head->type)
-    );
-    exit(0);
+    handleUnexpectedToken(p_head);
   }
 
   AstNode *res = AstNode_new(NULL, OP_APPLICATION, p_head->lineNumber);
   AstNode *p_lastChild = NULL;
 
-  // go to first token of first item item in application
-  Token *p_curr = p_head->p_next;
-  int i = 1;
-
-  while(p_curr->type != TOK_APPLYCLOSE && i < length) {
-
-    if (p_curr->type == TOK_APPLYOPEN || p_curr->type == TOK_FUNCOPEN) {
-      // case of value which is closure
-      // record first token
-      Token *p_start = p_curr;
-      int startIndex = i;
-    
-      // skip closure
-      skipClosure(&i, &p_curr, p_curr->type, p_curr->type + 1, length);
+  // go to first token of first item in application
+  Lexer_advance(p_lexer);
 
-      // add child
-      AstNode_appendChild(res, &p_lastChild, parseValue(p_start, i - startIndex + 1));
-    } else {
-      // case of value not in closure
-      AstNode_appendChild(res, &p_lastChild, parseValue(p_curr, 1));
-    }
-
-    p_curr = p_curr->p_next;
-    i++;
-  }
-  
-  if (p_curr->type != TOK_APPLYCLOSE) {
-    // error handling for invalid closing token
-    printf(
-      "Syntax Error @ Line %i: Application not closed.\n", 
-      p_curr->lineNumber
-    );
-    exit(0);
+  // parse values until close (an end token is handled by parseValue)
+  while (Lexer_peek(p_lexer, 0)->type != TOK_APPLYCLOSE) {
+    AstNode_appendChild(res, &p_lastChild, parseValue(p_lexer));
   }
 
+  // consume close
+  Lexer_advance(p_lexer);
+
   return res;
 }
 
 // parse value
 // ebnf: value = application | function | int | float | string | identifier;
-AstNode *parseValue(Token *p_head, int length) {
-  if (length == 1) {
-    // int, float, or string
-    if (p_head->type == TOK_STRING) {
-      return AstNode_new(p_head->val, OP_STRING, p_head->lineNumber);
-    } else if (p_head->type == TOK_FLOAT) {
-      return AstNode_new(p_head->val, OP_FLOAT, p_head->lineNumber);
-    } else if (p_head->type == TOK_INT) {
-      return AstNode_new(p_head->val, OP_INT, p_head->lineNumber);
-    } else if (p_head->type == TOK_IDENTIFIER) {
-      return AstNode_new(p_head->val, OP_IDENTIFIER, p_head->lineNumber);
-    } else {
-      printf(
-        "Syntax Error @ Line %i: Unexpected %s token.\n", 
-        p_head->lineNumber, getTokenTypeString(p_head->type)
-      );
-      exit(0);
-    }
-  } else if (length > 1) {
-    // application and function
-    if (p_head->type == TOK_APPLYOPEN) {
-      return parseApplication(p_head, length);
-    } else if (p_head->type == TOK_FUNCOPEN) {
-      return parseFunction(p_head, length);    
-    } else {
-      printf(
-        "Syntax Error @ Line %i: Unexpected %s token.\n", 
-        p_head->lineNumber, getTokenTypeString(p_head->type)
-      );
-      exit(0);
-    }
-  }
+AstNode *parseValue(Lexer *p_lexer) {
+  Token *p_head = Lexer_peek(p_lexer, 0);
+
+  // application and function
+  if (p_head->type == TOK_APPLYOPEN) return parseApplication(p_lexer);
+  if (p_head->type == TOK_FUNCOPEN) return parseFunction(p_lexer);
+
+  // int, float, string, or identifier
+  AstNode *res = NULL;
 
-  return NULL;
+  if (p_head->type == TOK_STRING) res = newTokenNode(p_head, OP_STRING);
+  else if (p_head->type == TOK_FLOAT) res = newTokenNode(p_head, OP_FLOAT);
+  else if (p_head->type == TOK_INT) res = newTokenNode(p_head, OP_INT);
+  else if (p_head->type == TOK_IDENTIFIER) res = newTokenNode(p_head, OP_IDENTIFIER);
+  else handleUnexpectedToken(p_head);
+
+  Lexer_advance(p_lexer);
+  return res;
 }
 
 // parse assignment
 // ebnf: assignment = identifier, "=", value;
-AstNode *parseAssignment(Token *p_head, int length) {
-  if (length < 3) {
-    printf(
-      "Syntax Error @ Line %i: Incomplete assignment.\n", 
-      p_head->lineNumber
-    );
-    exit(0);
+AstNode *parseAssignment(Lexer *p_lexer) {
+  Token *p_head = Lexer_peek(p_lexer, 0);
 
-  } else if (p_head->type != TOK_IDENTIFIER) {
+  if (p_head->type != TOK_IDENTIFIER) {
     // error handling if first token not identifier
-    printf(
-      "Syntax Error @ Line %i: Unexpected %s token.\n", 
-      p_head->lineNumber, getTokenTypeString(p_head->type)
-    );
-    exit(0); 
+    handleUnexpectedToken(p_head);
+  }
 
-  } else if (p_head->p_next->type != TOK_ASSIGNMENT) {
+  // create node
+  AstNode *res = AstNode_new(NULL, OP_ASSIGNMENT, p_head->lineNumber);
+  res->p_headChild = newTokenNode(p_head, OP_IDENTIFIER);
+
+  if (Lexer_peek(p_lexer, 1)->type != TOK_ASSIGNMENT) {
     // error handling if second token not assignment
-    printf(
-      "Syntax Error @ Line %i: Unexpected %s token.\n", 
-      p_head->p_next->lineNumber, getTokenTypeString(p_head->p_next->type)
-    );
-    exit(0); 
+    handleUnexpectedToken(Lexer_peek(p_lexer, 1));
+  }
 
-  } else {
-    // create node and return
-    AstNode *res = AstNode_new(NULL, OP_ASSIGNMENT, p_head->lineNumber);
-    res->p_headChild = AstNode_new(p_head->val, OP_IDENTIFIER, p_head->lineNumber);
-    res->p_headChild->p_next = parseValue(p_head->p_next->p_next, length - 2);
+  // skip identifier and "=", and parse value
+  Lexer_advance(p_lexer);
+  Lexer_advance(p_lexer);
+  res->p_headChild->p_next = parseValue(p_lexer);
 
-    return res;
-  }
+  return res;
 }
 
 // parse return
 // ebnf: return = "<-", value;
-AstNode *parseReturn(Token *p_head, int length) {
-  if (length < 2) {
-    printf(
-      "Syntax Error @ Line %i: Incomplete return.\n", 
-      p_head->lineNumber
-    );
-    exit(0);
+AstNode *parseReturn(Lexer *p_lexer) {
+  Token *p_head = Lexer_peek(p_lexer, 0);
+  if (p_head->type != TOK_RETURN) handleUnexpectedToken(p_head);
 
-  } else if (p_head->type != TOK_RETURN) {
-    printf(
-      "Syntax Error @ Line %i: Unexpected %s token.\n", 
-      p_head->lineNumber, getTokenTypeString(p_head->type)
-    );
-    exit(0);
+  AstNode *res = AstNode_new(NULL, OP_RETURN, p_head->lineNumber);
+  Lexer_advance(p_lexer);
+  res->p_headChild = parseValue(p_lexer);
 
-  } else {
-    AstNode *res = AstNode_new(NULL, OP_RETURN, p_head->lineNumber);
-    res->p_headChild = parseValue(p_head->p_next, length - 1);
-    return res;
-  }
+  return res;
 }
 
-// parse statement
+// parse statement, until a token of type close (not consumed)
+// p_argumentError is the first token which is not an argument, for the body of a function without arguments, else NULL
+// statements of a program (closed by the end token) release their tokens once parsed, so that only one is held at a time
 // ebnf: statement = {return | assignment | value};
 // precedence: return, assignment, value
-AstNode *parseStatement(Token *p_head, int length) {
+AstNode *parseStatement(Lexer *p_lexer, enum TokenType close, Token *p_argumentError) {
 
   // create ast node for statement
-  AstNode *res = AstNode_new(NULL, OP_STATEMENT, p_head->lineNumber);
-  AstNode *p_lastChild = res->p_headChild;
+  AstNode *res = AstNode_new(NULL, OP_STATEMENT, Lexer_peek(p_lexer, 0)->lineNumber);
+  AstNode *p_lastChild = NULL;
 
   // for each token
-  Token *p_curr = p_head;
-  int i = 0;
-
-  while (p_curr != NULL && i < length) {
-    if (p_curr->type == TOK_RETURN) {
+  enum TokenType type;
+  while ((type = Lexer_peek(p_lexer, 0)->type) != close) {
+    if (type == TOK_RETURN) {
       // return case
-      // first token of return
-      Token *p_returnStart = p_curr; 
-      int returnIndex = i;
-
-      if (p_curr->p_next->type == TOK_APPLYOPEN || p_curr->p_next->type == TOK_FUNCOPEN) {
-
-        // go to open apply token
-        p_curr = p_curr->p_next;
-        i++;
-
-        // skip closure
-        // we pass the type + 1 as the close type, as closing types are 1 + the respective opening type
-        skipClosure(&i, &p_curr, p_curr->type, p_curr->type + 1, length);
-
-        // add parsed return expression to result
-        AstNode_appendChild(res, &p_lastChild, parseReturn(p_returnStart, i - returnIndex + 1));
-
-      } else {
-        // parse return with next token
-        AstNode_appendChild(res, &p_lastChild, parseReturn(p_returnStart, 2));
-
-        // increment
-        i++;
-        p_curr = p_curr->p_next;
-      }
-    } else if (p_curr->type == TOK_IDENTIFIER && p_curr->p_next->type == TOK_ASSIGNMENT) {
+      AstNode_appendChild(res, &p_lastChild, parseReturn(p_lexer));
+    } else if (type == TOK_IDENTIFIER && Lexer_peek(p_lexer, 1)->type == TOK_ASSIGNMENT) {
       // assignment case
-      // first token of assignment
-      Token *p_assignmentStart = p_curr;
-      int assignmentIndex = i;
-
-      // increment step by 1
-      p_curr = p_curr->p_next;
-      i++;
-      
-      // if closure
-      if (p_curr->p_next->type == TOK_APPLYOPEN || p_curr->p_next->type == TOK_FUNCOPEN) {
-
-        // go to open apply token
-        p_curr = p_curr->p_next;
-        i++;
-
-        // skip closure
-        // we pass the type + 1 as the close type, as closing types are 1 + the respective opening type
-        skipClosure(&i, &p_curr, p_curr->type, p_curr->type + 1, length);
-
-        // add parsed return expression to result
-        AstNode_appendChild(res, &p_lastChild, parseAssignment(p_assignmentStart, i - assignmentIndex + 1));
-
-      } else {
-        // do assignment with next token
-        AstNode_appendChild(res, &p_lastChild, parseAssignment(p_assignmentStart, 3));
-
-        // increment
-        i++;
-        p_curr = p_curr->p_next;
-      }
-    } else if (p_curr->type == TOK_APPLYOPEN || p_curr->type == TOK_FUNCOPEN) {
-      // case of value which is closure
-      // record first token
-      Token *p_start = p_curr;
-      int startIndex = i;
-     
-      // skip closure
-      skipClosure(&i, &p_curr, p_curr->type, p_curr->type + 1, length);
-
-      // add child
-      AstNode_appendChild(res, &p_lastChild, parseValue(p_start, i - startIndex + 1));
+      AstNode_appendChild(res, &p_lastChild, parseAssignment(p_lexer));
+    } else if (type == TOK_ARROW && p_argumentError != NULL) {
+      // arrow after something other than arguments, throw error on the first token which is not an argument
+      handleUnexpectedToken(p_argumentError);
     } else {
-      // case of value not in closure
-      AstNode_appendChild(res, &p_lastChild, parseValue(p_curr, 1));
+      // value case
+      AstNode_appendChild(res, &p_lastChild, parseValue(p_lexer));
     }
 
-    i++;
-    p_curr = p_curr->p_next;
+    if (close == TOK_END) Lexer_release(p_lexer);
   }
 
   return res;
@@ -281,86 +169,228 @@ AstNode *parseStatement(Token *p_head, int length) {
 
 // parse function
 // ebnf: function = "{", [{identifier, ","}, identifier, "->"], statement, "}";
-AstNode *parseFunction(Token *p_head, int length) {
+AstNode *parseFunction(Lexer *p_lexer) {
+  Token *p_head = Lexer_peek(p_lexer, 0);
 
   // if first token is not {, return error
-  if (p_head->type != TOK_FUNCOPEN) {
-    printf(
-      "Syntax Error @ Line %i: Unexpected %s token.\n", 
-      p_head->lineNumber, getTokenTypeString(p_head->type)
-    );
-
-    exit(0);
-  }
+  if (p_head->type != TOK_FUNCOPEN) handleUnexpectedToken(p_head);
 
   // create res
   AstNode *res = AstNode_new(NULL, OP_FUNCTION, p_head->lineNumber);
   AstNode *p_lastChild = NULL;
 
-  // skip to end of function or arrow
-  Token *p_curr = p_head;
-  int i = 0;
+  // go to first token of function
+  Lexer_advance(p_lexer);
 
-  while (p_curr->type != TOK_ARROW && i < length - 1) {
-    p_curr = p_curr->p_next;
-    if (p_curr->type == TOK_FUNCOPEN) skipClosure(&i, &p_curr, TOK_FUNCOPEN, TOK_FUNCCLOSE, length);
-    i++;
-  }
+  // arguments are identifiers followed by an arrow, look ahead past identifiers to check for one
+  int argumentCount = 0;
+  while (Lexer_peek(p_lexer, argumentCount)->type == TOK_IDENTIFIER) argumentCount++;
 
-  if (p_curr->type == TOK_FUNCCLOSE) {
-    // case where there are no arguments
-    res->p_headChild = parseStatement(p_head->p_next, length - 2);
-  } else if (p_curr->type == TOK_ARROW) {
+  if (Lexer_peek(p_lexer, argumentCount)->type == TOK_ARROW) {
     // case where there are arguments
-    // go to first argument
-    Token *p_curr = p_head->p_next;
-
-    while (p_curr->type != TOK_ARROW) {
-      if (p_curr->type != TOK_IDENTIFIER) {
-        // error handling in case identifier not found
-        printf(
-          "Syntax Error @ Line %i: Unexpected %s token.\n", 
-          p_curr->lineNumber, getTokenTypeString(p_curr->type)
-        );
-
-        exit(0);
-      }
-
-      // add identifier
-      AstNode_appendChild(res, &p_lastChild, AstNode_new(p_curr->val, OP_IDENTIFIER, p_curr->lineNumber));
-      p_curr = p_curr->p_next;
+    for (int i = 0; i < argumentCount; i++) {
+      AstNode_appendChild(res, &p_lastChild, newTokenNode(Lexer_peek(p_lexer, 0), OP_IDENTIFIER));
+      Lexer_advance(p_lexer);
     }
 
-    // add statement
-    AstNode_appendChild(res, &p_lastChild, parseStatement(p_curr->p_next, length - i - 2));
-    
+    // skip arrow, and add statement
+    Lexer_advance(p_lexer);
+    AstNode_appendChild(res, &p_lastChild, parseStatement(p_lexer, TOK_FUNCCLOSE, NULL));
   } else {
-    printf(
-      "Syntax Error @ Line %i: Unexpected %s token.\n", 
-      p_curr->lineNumber, getTokenTypeString(p_curr->type)
-    );
-
-    exit(0);
+    // case where there are no arguments
+    // copy the token after the identifiers, as tokens may move while parsing
+    Token argumentError = *Lexer_peek(p_lexer, argumentCount);
+    res->p_headChild = parseStatement(p_lexer, TOK_FUNCCLOSE, &argumentError);
   }
 
+  // consume close
+  Lexer_advance(p_lexer);
+
   return res;
 }
 
-// parse program
+// parse program, pulling tokens from p_lexer
 // ebnf: program = start, statement, end;
-AstNode *parseProgram(Token *p_head, int length) {
-  if (p_head->type != TOK_START) {
+AstNode *parseProgram(Lexer *p_lexer) {
+  if (Lexer_peek(p_lexer, 0)->type != TOK_START) {
     printf("Syntax Error @ Line 1: Missing start token.\n");
     exit(0);
   }
 
-  Token *p_curr = p_head;
-  for (int i = 0; i < length - 1; i++) p_curr = p_curr->p_next;
-  
-  if(p_curr->type != TOK_END) {
-    printf("Syntax Error @ Line %i: Missing end token.\n", p_curr->lineNumber);
-    exit(0);
+  // parse statement from the first token after start, until end
+  Lexer_advance(p_lexer);
+  return parseStatement(p_lexer, TOK_END, NULL);
+}
+
+// returns the index of the first char from i which is not whitespace or in a comment, or length if there is none
+int skipInsignificant(char *code, int i, int length) {
+  while (i < length) {
+    if (code[i] == '/' && code[i + 1] == '/') {
+      while (i < length && code[i] != '\n') i++;
+    } else if (code[i] == ' ' || (code[i] >= '\t' && code[i] <= '\r')) {
+      i++;
+    } else break;
+  }
+
+  return i;
+}
+
+// splits code with length length into at most maxChunks chunks of at least chunkSize chars
+// splits are made only at newlines between top level statements, outside of strings, comments and brackets
+// and not after "=" or "<-", or before "=", so that each chunk parses to the statements it would have in the whole code
+// stores the first char and line number of each chunk in starts and lineNumbers, with starts[count] = length, and returns count
+int splitChunks(char *code, int length, int chunkSize, int maxChunks, int *starts, int *lineNumbers) {
+  int count = 1;
+  starts[0] = 0;
+  lineNumbers[0] = 1;
+
+  int depth = 0;
+  int lineNumber = 1;
+
+  // index of the last char of the last token, -1 if there is none
+  int last = -1;
+
+  for (int i = 0; i < length && count < maxChunks; i++) {
+    char c = code[i];
+
+    if (c == '\n') {
+      lineNumber++;
+
+      if (
+        depth == 0
+        && i + 1 - starts[count - 1] >= chunkSize
+        && !(last >= 0 && code[last] == '=')
+        && !(last >= 1 && code[last] == '-' && code[last - 1] == '<')
+        && code[skipInsignificant(code, i + 1, length)] != '='
+      ) {
+        starts[count] = i + 1;
+        lineNumbers[count] = lineNumber;
+        count++;
+      }
+    } else if (c == '/' && code[i + 1] == '/') {
+      // comments, stop before the newline so that it is handled above
+      char *p_newline = memchr(&code[i], '\n', length - i);
+      i = (p_newline == NULL ? length : p_newline - code) - 1;
+    } else if (c == '"') {
+      // strings, stop on the closing quote, or before anything else ending it (an error, handled by the lexer)
+      i = Vector_findStringEnd(code, i + 1, length);
+      while (i < length && code[i] == '\\' && code[i + 1] != '\n') {
+        i = Vector_findStringEnd(code, i + 2, length);
+      }
+
+      if (i >= length || code[i] != '"') i--;
+      last = i;
+    } else if (c != ' ' && !(c >= '\t' && c <= '\r')) {
+      if (c == '(' || c == '{') depth++;
+      if (c == ')' || c == '}') depth--;
+      last = i;
+    }
   }
 
-  return parseStatement(p_head->p_next, length - 2);
+  starts[count] = length;
+  return count;
+}
+
+// chunks of code being parsed in parallel, see parseCode
+typedef struct ParseJob {
+  char *code;
+  int *starts;
+  int *lineNumbers;
+  AstNode **results;
+  bool failed;
+} ParseJob;
+
+// parses chunks [start, end) of a parse job
+// a chunk with a syntax error is abandoned, and marks the job as failed
+void parseChunksTask(void *p_data, int chunk, int start, int end, int worker) {
+  ParseJob *p_job = (ParseJob *) p_data;
+
+  for (int i = start; i < end; i++) {
+    jmp_buf syntaxError;
+    if (setjmp(syntaxError) != 0) {
+      // the chunk's lexer and partial ast are lost, as the code is about to be parsed again to report the error
+      p_syntaxErrorJump = NULL;
+      p_job->results[i] = NULL;
+      __atomic_store_n(&p_job->failed, true, __ATOMIC_RELAXED);
+      continue;
+    }
+
+    p_syntaxErrorJump = &syntaxError;
+
+    // lex the chunk from its first line, skipping its start token
+    Lexer *p_lexer = Lexer_new(&p_job->code[p_job->starts[i]], p_job->starts[i + 1] - p_job->starts[i]);
+    p_lexer->lineNumber = p_job->lineNumbers[i];
+    Lexer_advance(p_lexer);
+
+    p_job->results[i] = parseStatement(p_lexer, TOK_END, NULL);
+    Lexer_free(p_lexer);
+
+    p_syntaxErrorJump = NULL;
+  }
+}
+
+// lexes and parses code with length length into a program
+// large code is split into chunks (see splitChunks), which are lexed and parsed in parallel, and joined in order into one statement
+// if any chunk has a syntax error, the code is parsed again as a whole, so that the first error is reported
+AstNode *parseCode(char *code, int length) {
+  int maxChunks = Pool_size();
+  int chunkSize = length / maxChunks > PARSE_CHUNK_MIN_SIZE ? length / maxChunks : PARSE_CHUNK_MIN_SIZE;
+
+  if (maxChunks > 1 && length >= 2 * chunkSize) {
+    ParseJob job;
+    job.code = code;
+    job.starts = (int *) malloc(sizeof(int) * (maxChunks + 1));
+    job.lineNumbers = (int *) malloc(sizeof(int) * maxChunks);
+    job.failed = false;
+
+    int count = splitChunks(code, length, chunkSize, maxChunks, job.starts, job.lineNumbers);
+    job.results = (AstNode **) malloc(sizeof(AstNode *) * count);
+
+    if (count > 1) Pool_run(&parseChunksTask, &job, count, count);
+
+    AstNode *res = NULL;
+
+    if (count > 1 && !job.failed) {
+      // join the statements of every chunk into the first
+      // the statement takes the line of its first child, as it would have in the whole code
+      res = job.results[0];
+      AstNode *p_lastChild = res->p_headChild;
+      while (p_lastChild != NULL && p_lastChild->p_next != NULL) p_lastChild = p_lastChild->p_next;
+
+      for (int i = 1; i < count; i++) {
+        AstNode *p_chunk = job.results[i];
+
+        if (p_chunk->p_headChild != NULL) {
+          if (p_lastChild == NULL) {
+            res->p_headChild = p_chunk->p_headChild;
+            res->lineNumber = p_chunk->lineNumber;
+          } else p_lastChild->p_next = p_chunk->p_headChild;
+
+          p_lastChild = p_chunk->p_headChild;
+          while (p_lastChild->p_next != NULL) p_lastChild = p_lastChild->p_next;
+        } else if (p_lastChild == NULL) res->lineNumber = p_chunk->lineNumber;
+
+        p_chunk->p_headChild = NULL;
+        AstNode_free(p_chunk);
+      }
+    } else if (count > 1) {
+      // free the chunks which parsed, before parsing again
+      for (int i = 0; i < count; i++) {
+        if (job.results[i] != NULL) AstNode_free(job.results[i]);
+      }
+    }
+
+    free(job.starts);
+    free(job.lineNumbers);
+    free(job.results);
+
+    if (res != NULL) return res;
+  }
+
+  // parse as a whole
+  Lexer *p_lexer = Lexer_new(code, length);
+  AstNode *res = parseProgram(p_lexer);
+  Lexer_free(p_lexer);
+
+  return res;
 }
\ No newline at end of file
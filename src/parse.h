@@ -1,17 +1,18 @@
 #ifndef PARSE_H
 #define PARSE_H
 #include "tokens.h"
+#include "lex.h"
 #include "ast.h"
 
 // prototypes
-void skipClosure(int *, Token **, enum TokenType, enum TokenType, int);
-
-AstNode *parseValue(Token *, int);
-AstNode *parseAssignment(Token *, int);
-AstNode *parseStatement(Token *, int);
-AstNode *parseApplication(Token *, int);
-AstNode *parseReturn(Token *, int);
-AstNode *parseFunction(Token *, int);
-AstNode *parseProgram(Token *, int);
+AstNode *newTokenNode(Token *, enum Opcodes);
+AstNode *parseValue(Lexer *);
+AstNode *parseAssignment(Lexer *);
+AstNode *parseStatement(Lexer *, enum TokenType, Token *);
+AstNode *parseApplication(Lexer *);
+AstNode *parseReturn(Lexer *);
+AstNode *parseFunction(Lexer *);
+AstNode *parseProgram(Lexer *);
+AstNode *parseCode(char *, int);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "pool.h"
+
+// work stealing thread pool, used by pmap and preduce
+// a job is split into chunks, which are dealt out to a queue per worker
+// workers take chunks from the back of their own queue, and once it is empty, steal from the front of the others
+
+// stack size for workers, as eval recurses deeply
+#define POOL_STACK_SIZE (64 * 1024 * 1024)
+
+// a worker's queue of chunk indices, front to back
+// generation is the job the chunks belong to, so that a worker still finishing an old job never takes chunks of a new one
+typedef struct PoolQueue {
+  pthread_mutex_t lock;
+  int generation;
+  int *chunks;
+  int front;
+  int back;
+} PoolQueue;
+
+// a job run by the pool
+// generation is incremented for every job, so that workers know when there is a new one
+typedef struct PoolJob {
+  int generation;
+  PoolTask task;
+  void *p_data;
+  int length;
+  int chunkCount;
+} PoolJob;
+
+// state of the pool, and of the job it is running
+// job is only read or written while holding lock, workers run chunks from their own copy of it
+// jobLock is held for a whole job, so that threads started by spawn take turns using the pool
+typedef struct Pool {
+  int size;
+  PoolQueue *queues;
+  pthread_mutex_t jobLock;
+  pthread_mutex_t lock;
+  pthread_cond_t jobReady;
+  pthread_cond_t jobDone;
+  int active;
+  int remaining;
+  PoolJob job;
+} Pool;
+
+Pool pool = {
+  .size = 0,
+  .jobLock = PTHREAD_MUTEX_INITIALIZER,
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+  .jobReady = PTHREAD_COND_INITIALIZER,
+  .jobDone = PTHREAD_COND_INITIALIZER
+};
+
+// index of the worker running on this thread, -1 if not a worker
+__thread int currentWorker = -1;
+
+// takes a chunk of the job with generation for worker, from its own queue if possible, else from another worker's
+// returns -1 if every queue is empty, or holds chunks of another job
+int takeChunk(int worker, int generation) {
+  PoolQueue *p_own = &pool.queues[worker];
+
+  pthread_mutex_lock(&p_own->lock);
+  int res = p_own->generation == generation && p_own->front < p_own->back ? p_own->chunks[--p_own->back] : -1;
+  pthread_mutex_unlock(&p_own->lock);
+
+  for (int i = 1; res == -1 && i < pool.size; i++) {
+    PoolQueue *p_victim = &pool.queues[(worker + i) % pool.size];
+
+    pthread_mutex_lock(&p_victim->lock);
+    if (p_victim->generation == generation && p_victim->front < p_victim->back) res = p_victim->chunks[p_victim->front++];
+    pthread_mutex_unlock(&p_victim->lock);
+  }
+
+  return res;
+}
+
+// runs a single chunk of p_job
+void runChunk(PoolJob *p_job, int chunk, int worker) {
+  int start = (long long) p_job->length * chunk / p_job->chunkCount;
+  int end = (long long) p_job->length * (chunk + 1) / p_job->chunkCount;
+  p_job->task(p_job->p_data, chunk, start, end, worker);
+}
+
+// main loop of a worker thread
+void *workerMain(void *p_arg) {
+  currentWorker = (int) (size_t) p_arg;
+  int seen = 0;
+
+  while (true) {
+    // wait for a new job
+    pthread_mutex_lock(&pool.lock);
+    while (pool.job.generation == seen) pthread_cond_wait(&pool.jobReady, &pool.lock);
+    PoolJob job = pool.job;
+    seen = job.generation;
+    pool.active++;
+    pthread_mutex_unlock(&pool.lock);
+
+    int chunk;
+    int done = 0;
+    while ((chunk = takeChunk(currentWorker, job.generation)) != -1) {
+      runChunk(&job, chunk, currentWorker);
+      done++;
+    }
+
+    // report back, waking the caller once every chunk is done
+    pthread_mutex_lock(&pool.lock);
+    pool.remaining -= done;
+    pool.active--;
+    if (pool.remaining == 0 && pool.active == 0) pthread_cond_signal(&pool.jobDone);
+    pthread_mutex_unlock(&pool.lock);
+  }
+
+  return NULL;
+}
+
+// returns the number of workers in the pool
+// one per cpu, unless overridden with the CRUMB_THREADS environment variable
+// size is computed on first use, and may be computed by several threads at once (which all get the same result)
+int Pool_size() {
+  int size = __atomic_load_n(&pool.size, __ATOMIC_RELAXED);
+  if (size != 0) return size;
+
+  char *threads = getenv("CRUMB_THREADS");
+  size = threads != NULL ? atoi(threads) : (int) sysconf(_SC_NPROCESSORS_ONLN);
+  if (size < 1) size = 1;
+
+  __atomic_store_n(&pool.size, size, __ATOMIC_RELAXED);
+  return size;
+}
+
+// starts the worker threads
+void startPool() {
+  pool.queues = (PoolQueue *) malloc(sizeof(PoolQueue) * pool.size);
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, POOL_STACK_SIZE);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+  for (int i = 0; i < pool.size; i++) {
+    pthread_mutex_init(&pool.queues[i].lock, NULL);
+    pool.queues[i].generation = 0;
+    pool.queues[i].chunks = NULL;
+    pool.queues[i].front = 0;
+    pool.queues[i].back = 0;
+
+    pthread_t thread;
+    if (pthread_create(&thread, &attr, workerMain, (void *) (size_t) i) != 0) {
+      printf("Runtime Error: Could not start worker thread.\n");
+      exit(0);
+    }
+  }
+
+  pthread_attr_destroy(&attr);
+}
+
+// runs task on every index in [0, length), split into chunkCount chunks, and waits for it to finish
+// runs everything on the calling thread if there is only one worker, or if called from a worker (ie. nested pmap)
+void Pool_run(PoolTask task, void *p_data, int length, int chunkCount) {
+  if (length == 0) return;
+  if (chunkCount > length) chunkCount = length;
+
+  if (Pool_size() == 1 || currentWorker != -1) {
+    int worker = currentWorker == -1 ? 0 : currentWorker;
+
+    for (int i = 0; i < chunkCount; i++) {
+      task(p_data, i, (long long) length * i / chunkCount, (long long) length * (i + 1) / chunkCount, worker);
+    }
+
+    return;
+  }
+
+  pthread_mutex_lock(&pool.jobLock);
+  if (pool.queues == NULL) startPool();
+
+  pthread_mutex_lock(&pool.lock);
+
+  // publish the job before dealing out its chunks, so that they are only ever run as part of it
+  pool.job.generation++;
+  pool.job.task = task;
+  pool.job.p_data = p_data;
+  pool.job.length = length;
+  pool.job.chunkCount = chunkCount;
+  pool.remaining = chunkCount;
+
+  // deal out consecutive chunks to each worker
+  for (int i = 0; i < pool.size; i++) {
+    PoolQueue *p_queue = &pool.queues[i];
+    int first = chunkCount * i / pool.size;
+    int last = chunkCount * (i + 1) / pool.size;
+
+    pthread_mutex_lock(&p_queue->lock);
+    p_queue->generation = pool.job.generation;
+    p_queue->chunks = (int *) realloc(p_queue->chunks, sizeof(int) * (last - first + 1));
+    p_queue->front = 0;
+    p_queue->back = last - first;
+
+    // the owner works from the back, so store its chunks in reverse to run them in order
+    for (int j = 0; j < last - first; j++) p_queue->chunks[j] = last - 1 - j;
+    pthread_mutex_unlock(&p_queue->lock);
+  }
+
+  pthread_cond_broadcast(&pool.jobReady);
+
+  while (pool.remaining > 0 || pool.active > 0) pthread_cond_wait(&pool.jobDone, &pool.lock);
+  pthread_mutex_unlock(&pool.lock);
+  pthread_mutex_unlock(&pool.jobLock);
+}
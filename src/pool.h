@@ -0,0 +1,12 @@
+#ifndef POOL_H
+#define POOL_H
+
+// task run by the pool on a chunk of indices [start, end)
+// worker is the index of the worker running the chunk, in [0, Pool_size())
+typedef void (*PoolTask)(void *p_data, int chunk, int start, int end, int worker);
+
+// prototypes
+int Pool_size();
+void Pool_run(PoolTask, void *, int, int);
+
+#endif
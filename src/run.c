@@ -10,47 +10,56 @@
 #include "lex.h"
 #include "ast.h"
 #include "parse.h"
+#include "fuse.h"
+#include "fold.h"
+#include "inline.h"
 #include "events.h"
 #include "stdlib.h"
 #include "eval.h"
 #include "file.h"
 #include "scope.h"
+#include "symbol.h"
+#include "timer.h"
 
 void exitHandler() {  
   exit(0);
 }
 
-int run(char *code, long length, int argc, char *argv[], bool debug) {
-  if (debug) {
-    printf("\nTOKENS\n");
-  }
-
-  /* lex */
-  // create initial token
-  Token *p_headToken = (Token *) malloc(sizeof(Token));
-  p_headToken->lineNumber = 1;
-  p_headToken->type = TOK_START;
-  p_headToken->val = NULL;
-  p_headToken->p_next = NULL;
-
-  int tokenCount = lex(p_headToken, code, length);
+int run(char *code, long length, int argc, char *argv[], bool debug, bool freeCode) {
+  // buffer output, before anything is printed
+  initOutput();
 
   if (debug) {
-    // print tokens
-    Token_print(p_headToken, tokenCount);
-    printf("Token Count: %i\n", tokenCount);
+    // print tokens, lexed on their own, as the parser only holds a statement's tokens at a time
+    printf("\nTOKENS\n");
+    TokenList *p_tokens = lex(code, length);
+    TokenList_print(p_tokens);
+    printf("Token Count: %i\n", p_tokens->length);
+    TokenList_free(p_tokens);
     printf("\nAST\n");
   }
 
-  /* parse */
-  AstNode *p_headAstNode = parseProgram(p_headToken, tokenCount);
+  /* lex and parse */
+  // the parser pulls tokens from a lexer as it needs them, and large code is parsed in chunks on multiple threads
+  AstNode *p_headAstNode = parseCode(code, length);
+  fuse(p_headAstNode);
+  inlineFunctions(p_headAstNode);
+  fold(p_headAstNode);
   
   if (debug) {
     // print AST
     AstNode_print(p_headAstNode, 0);
-    printf("\nEVAL\n");
   };
 
+  // the ast holds copies of what it needs, so the code is freed before evaluating (tokens are freed while parsing)
+  if (freeCode) {
+    free(code);
+    code = NULL;
+    if (debug) printf("Code Freed\n");
+  }
+
+  if (debug) printf("\nEVAL\n");
+
   /* evaluate */
   initEvents();
 
@@ -71,11 +80,6 @@ int run(char *code, long length, int argc, char *argv[], bool debug) {
   /* free */
   if (debug) printf("\nFREE\n");
 
-  // free tokens
-  Token_free(p_headToken);
-  p_headToken = NULL;
-  if (debug) printf("Tokens Freed\n");
-
   // free ast
   AstNode_free(p_headAstNode);
   p_headAstNode = NULL;
@@ -86,10 +90,18 @@ int run(char *code, long length, int argc, char *argv[], bool debug) {
   p_global = NULL;
   if (debug) printf("Global Scope Freed\n");
 
+  // free timers which were never applied
+  Timer_freeAll();
+  if (debug) printf("Timers Freed\n");
+
   // free file cache.
   FileCache_free();
   if (debug) printf("File Cache Freed\n");
 
+  // free symbols, once the ast and scopes holding them are freed
+  SymbolTable_free();
+  if (debug) printf("Symbols Freed\n");
+
   // free return code.
   Generic_free(res);
   res = NULL;
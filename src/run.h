@@ -3,6 +3,7 @@
 #include <stdbool.h>
 
 // prototypes
-int run(char *code, long length, int argc, char *argv[], bool debug);
+// if freeCode is set, code is freed once it is parsed
+int run(char *code, long length, int argc, char *argv[], bool debug, bool freeCode);
 
 #endif
\ No newline at end of file
@@ -19,6 +19,34 @@ Scope *Scope_new(Scope *p_parent) {
   Scope *res = (Scope *) malloc(sizeof(Scope));
   res->p_parent = p_parent;
   res->p_head = NULL;
+  res->p_shared = NULL;
+
+  return res;
+}
+
+// creates a new empty scope, for code running on another thread
+// variables are looked up in p_shared (and its parents), and copied into the new scope the first time they are used
+// so that the thread never touches the reference counts of values it shares with other threads
+// p_shared must not be modified while the new scope is in use
+Scope *Scope_newIsolated(Scope *p_shared) {
+  Scope *res = Scope_new(NULL);
+  res->p_shared = p_shared;
+
+  return res;
+}
+
+// creates a new scope holding a copy of every variable visible from p_target
+// used for code that runs alongside p_target on another thread, so p_target can keep changing
+Scope *Scope_snapshot(Scope *p_target) {
+  // copy outer scopes first, so that inner variables overwrite the ones they shadow
+  Scope *p_outer = p_target->p_shared != NULL ? p_target->p_shared : p_target->p_parent;
+  Scope *res = p_outer != NULL ? Scope_snapshot(p_outer) : Scope_new(NULL);
+
+  ScopeItem *p_curr = p_target->p_head;
+  while (p_curr != NULL) {
+    Scope_set(res, p_curr->key, Generic_copy(p_curr->p_val));
+    p_curr = p_curr->p_next;
+  }
 
   return res;
 }
@@ -39,21 +67,18 @@ void Scope_print(Scope *p_in) {
 }
 
 // gets a pointer to the scope
-// sets a key in the scope to val
+// sets a key (a symbol) in the scope to val
 // if the key does not exist, creates a new scope item to house it
 void Scope_set(Scope *p_target, char *key, Generic *p_val) {
   p_val->refCount++;
 
-  char *keyCopy = (char *) malloc(sizeof(char) * (strlen(key) + 1));
-  strcpy(keyCopy, key);
-
   // set p_p_curr to the ScopeItem with the correct key, or NULL if not found
   ScopeItem **p_p_curr = &(p_target->p_head);
-  while (*(p_p_curr) != NULL && strcmp((*p_p_curr)->key, keyCopy) != 0) p_p_curr = &((*p_p_curr)->p_next);
+  while (*(p_p_curr) != NULL && (*p_p_curr)->key != key) p_p_curr = &((*p_p_curr)->p_next);
 
   if (*p_p_curr == NULL) {
     // case where variable was previously undefined, create new item
-    *p_p_curr = ScopeItem_new(keyCopy, p_val);
+    *p_p_curr = ScopeItem_new(key, p_val);
   } else {
 
     // case where variable was previosuly defined, simply overwrite value, and decrease ref count of old value (if 0, free)
@@ -62,25 +87,27 @@ void Scope_set(Scope *p_target, char *key, Generic *p_val) {
       Generic_free((*p_p_curr)->p_val);
     } 
 
-    free((*p_p_curr)->key);
-
     (*p_p_curr)->p_val = p_val;
-    (*p_p_curr)->key = keyCopy;
   }
 }
 
-// returns the generic in the requested key of the target scope
+// returns the generic in the requested key (a symbol) of the target scope
 // if the generic cannot be found, attempts to search parent recursively
 Generic *Scope_get(Scope *p_target, char *key, int lineNumber) {
 
   // set p_curr to the item with correct key, or NULL
   ScopeItem *p_curr = p_target->p_head;
-  while (p_curr != NULL && strcmp(p_curr->key, key) != 0) p_curr = p_curr->p_next;
+  while (p_curr != NULL && p_curr->key != key) p_curr = p_curr->p_next;
 
   if (p_curr == NULL) {
     // key does not exist in current scope
     // if parent does not exist, we are in the global scope, and can throw an error, else elevate
-    if (p_target->p_parent == NULL) {
+    if (p_target->p_shared != NULL) {
+      // isolated scope, copy from the shared scope
+      Generic *p_val = Generic_copy(Scope_get(p_target->p_shared, key, lineNumber));
+      Scope_set(p_target, key, p_val);
+      return p_val;
+    } else if (p_target->p_parent == NULL) {
       // Error handling
       printf(
         "Runtime Error @ Line %i: %s is not defined.\n", 
@@ -110,7 +137,6 @@ void Scope_free(Scope *p_target) {
     p_tmp->p_val->refCount--;
     if (p_tmp->p_val->refCount == 0) Generic_free(p_tmp->p_val);
     
-    free(p_tmp->key);
     free(p_tmp);
   }
 
@@ -3,6 +3,7 @@
 #include "generic.h"
 
 // a key value pair held in Scope (linked list)
+// keys are symbols (see symbol.c), so they are compared by pointer, and not owned by the item
 typedef struct ScopeItem {
   char* key;
   Generic *p_val;
@@ -12,14 +13,18 @@ typedef struct ScopeItem {
 // scope (assigned to every statement)
 // every scope knows its parent, so that if a var is not in local scope, parent scope can be accesed
 // a scope contains a linked map of var names and values
+// p_shared is only set on isolated scopes (see Scope_newIsolated)
 typedef struct Scope {
   struct Scope *p_parent;
   ScopeItem *p_head;
+  struct Scope *p_shared;
 } Scope;
 
 // prototypes
 ScopeItem *ScopeItem_new(char*, Generic *);
 Scope *Scope_new(Scope *);
+Scope *Scope_newIsolated(Scope *);
+Scope *Scope_snapshot(Scope *);
 void Scope_print(Scope *);
 void Scope_set(Scope *, char *, Generic *);
 Generic *Scope_get(Scope *, char *, int);
@@ -0,0 +1,222 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include "sequence.h"
+#include "generic.h"
+#include "list.h"
+#include "scope.h"
+#include "coroutine.h"
+#include "stdlib.h"
+
+/* sequences */
+// allocates a sequence of kind, on top of p_source (which may be NULL)
+Sequence *Sequence_new(enum SequenceKind kind, Sequence *p_source) {
+  Sequence *res = (Sequence *) malloc(sizeof(Sequence));
+  res->refCount = 1;
+  res->kind = kind;
+  res->p_source = p_source;
+  res->p_func = NULL;
+  res->p_list = NULL;
+  res->count = 0;
+
+  if (p_source != NULL) Sequence_copy(p_source);
+  return res;
+}
+
+// sequence of the integers from 0 to count - 1
+Sequence *Sequence_range(int count) {
+  Sequence *res = Sequence_new(SEQUENCE_RANGE, NULL);
+  res->count = count;
+  return res;
+}
+
+// sequence of the items in a copy of p_list
+Sequence *Sequence_fromList(List *p_list) {
+  Sequence *res = Sequence_new(SEQUENCE_LIST, NULL);
+  res->p_list = List_copy(p_list);
+  return res;
+}
+
+// copies a function to be held by a sequence
+// the copy is referenced by the sequence, so that applyFunc does not free it
+Generic *holdFunc(Generic *p_func) {
+  Generic *res = Generic_copy(p_func);
+  res->refCount++;
+  return res;
+}
+
+// sequence of the values yielded by (func arg1 arg2 ...), where p_args holds the arguments
+// takes ownership of p_args
+Sequence *Sequence_generator(Generic *p_func, List *p_args) {
+  Sequence *res = Sequence_new(SEQUENCE_GENERATOR, NULL);
+  res->p_func = holdFunc(p_func);
+  res->p_list = p_args;
+  return res;
+}
+
+// sequence of (func item i) for every item in p_source
+Sequence *Sequence_map(Sequence *p_source, Generic *p_func) {
+  Sequence *res = Sequence_new(SEQUENCE_MAP, p_source);
+  res->p_func = holdFunc(p_func);
+  return res;
+}
+
+// sequence of the items in p_source for which (func item i) is 1
+Sequence *Sequence_filter(Sequence *p_source, Generic *p_func) {
+  Sequence *res = Sequence_new(SEQUENCE_FILTER, p_source);
+  res->p_func = holdFunc(p_func);
+  return res;
+}
+
+// sequence of the first count items of p_source
+Sequence *Sequence_take(Sequence *p_source, int count) {
+  Sequence *res = Sequence_new(SEQUENCE_TAKE, p_source);
+  res->count = count;
+  return res;
+}
+
+// sequences are immutable, so copies share the same sequence
+// copies can be on different threads (see pmap), so references are counted atomically
+Sequence *Sequence_copy(Sequence *p_target) {
+  __atomic_add_fetch(&p_target->refCount, 1, __ATOMIC_RELAXED);
+  return p_target;
+}
+
+// drops a reference to a sequence, freeing it once unreferenced
+void Sequence_free(Sequence *p_target) {
+  if (__atomic_sub_fetch(&p_target->refCount, 1, __ATOMIC_ACQ_REL) > 0) return;
+
+  if (p_target->p_source != NULL) Sequence_free(p_target->p_source);
+  if (p_target->p_func != NULL) Generic_free(p_target->p_func);
+  if (p_target->p_list != NULL) List_free(p_target->p_list);
+  free(p_target);
+}
+
+// consumes a sequence, returning a list of all of its items
+List *Sequence_collect(Sequence *p_target, Scope *p_scope, int lineNumber) {
+  int capacity = 16;
+  int length = 0;
+  Generic **items = (Generic **) malloc(sizeof(Generic *) * capacity);
+
+  SequenceIterator *p_iter = SequenceIterator_new(p_target);
+  Generic *p_item;
+
+  while ((p_item = SequenceIterator_next(p_iter, p_scope, lineNumber)) != NULL) {
+    if (length == capacity) {
+      capacity *= 2;
+      items = (Generic **) realloc(items, sizeof(Generic *) * capacity);
+    }
+
+    items[length++] = p_item;
+  }
+
+  SequenceIterator_free(p_iter);
+  return List_wrap(items, length);
+}
+
+/* iterators */
+// creates an iterator at the start of a sequence
+SequenceIterator *SequenceIterator_new(Sequence *p_seq) {
+  SequenceIterator *res = (SequenceIterator *) malloc(sizeof(SequenceIterator));
+  res->p_seq = p_seq;
+  res->p_source = p_seq->p_source == NULL ? NULL : SequenceIterator_new(p_seq->p_source);
+  res->index = 0;
+  res->p_coroutine = NULL;
+  res->p_scope = NULL;
+  res->lineNumber = 0;
+  return res;
+}
+
+// returns a new integer generic
+Generic *newIndex(int index) {
+  int *p_val = (int *) malloc(sizeof(int));
+  *p_val = index;
+  return Generic_new(TYPE_INT, p_val, 0);
+}
+
+// body of a generator's coroutine, runs the function with a copy of its arguments
+// every value passed to yield is returned by the iterator
+void runGenerator(void *p_data) {
+  SequenceIterator *p_iter = (SequenceIterator *) p_data;
+  List *p_args = p_iter->p_seq->p_list;
+
+  Generic *args[p_args->len + 1];
+  for (int i = 0; i < p_args->len; i++) args[i] = List_get(p_args, i);
+
+  Generic *res = applyFunc(p_iter->p_seq->p_func, p_iter->p_scope, args, p_args->len, p_iter->lineNumber);
+  if (res->refCount == 0) Generic_free(res);
+}
+
+// returns the next item in the sequence, or NULL once it is exhausted
+// the item belongs to the caller
+Generic *SequenceIterator_next(SequenceIterator *p_iter, Scope *p_scope, int lineNumber) {
+  Sequence *p_seq = p_iter->p_seq;
+
+  switch (p_seq->kind) {
+    case SEQUENCE_RANGE:
+      if (p_iter->index >= p_seq->count) return NULL;
+      return newIndex(p_iter->index++);
+
+    case SEQUENCE_LIST:
+      if (p_iter->index >= p_seq->p_list->len) return NULL;
+      return List_get(p_seq->p_list, p_iter->index++);
+
+    case SEQUENCE_GENERATOR:
+      // the generator starts on the first pull, in the scope of the consumer
+      if (p_iter->p_coroutine == NULL) {
+        p_iter->p_scope = p_scope;
+        p_iter->lineNumber = lineNumber;
+        p_iter->p_coroutine = Coroutine_new(&runGenerator, p_iter);
+      }
+
+      return Coroutine_resume(p_iter->p_coroutine);
+
+    case SEQUENCE_TAKE:
+      if (p_iter->index >= p_seq->count) return NULL;
+      p_iter->index++;
+      return SequenceIterator_next(p_iter->p_source, p_scope, lineNumber);
+
+    case SEQUENCE_MAP: {
+      Generic *p_item = SequenceIterator_next(p_iter->p_source, p_scope, lineNumber);
+      if (p_item == NULL) return NULL;
+
+      Generic *args[] = {p_item, newIndex(p_iter->index++)};
+      Generic *res = applyFunc(p_seq->p_func, p_scope, args, 2, lineNumber);
+
+      // results still held elsewhere are copied, so that the caller owns the item
+      return res->refCount == 0 ? res : Generic_copy(res);
+    }
+
+    case SEQUENCE_FILTER:
+      while (true) {
+        Generic *p_item = SequenceIterator_next(p_iter->p_source, p_scope, lineNumber);
+        if (p_item == NULL) return NULL;
+
+        // fn gets a copy, as applyFunc frees its arguments
+        Generic *args[] = {Generic_copy(p_item), newIndex(p_iter->index++)};
+        Generic *p_keep = applyFunc(p_seq->p_func, p_scope, args, 2, lineNumber);
+
+        if (p_keep->type != TYPE_INT || (*((int *) p_keep->p_val) != 0 && *((int *) p_keep->p_val) != 1)) {
+          printf(
+            "Runtime Error @ Line %i: filter function expected fn to return 0 or 1.\n",
+            lineNumber
+          );
+          exit(0);
+        }
+
+        int keep = *((int *) p_keep->p_val);
+        if (p_keep->refCount == 0) Generic_free(p_keep);
+
+        if (keep) return p_item;
+        Generic_free(p_item);
+      }
+  }
+
+  return NULL;
+}
+
+void SequenceIterator_free(SequenceIterator *p_iter) {
+  if (p_iter->p_source != NULL) SequenceIterator_free(p_iter->p_source);
+  if (p_iter->p_coroutine != NULL) Coroutine_free(p_iter->p_coroutine);
+  free(p_iter);
+}
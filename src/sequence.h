@@ -0,0 +1,59 @@
+#ifndef SEQUENCE_H
+#define SEQUENCE_H
+#include "generic.h"
+#include "list.h"
+#include "scope.h"
+#include "coroutine.h"
+
+// kinds of sequence
+// ranges, lists and generators are sources, the rest transform the items of p_source as they are pulled
+enum SequenceKind {
+  SEQUENCE_RANGE,
+  SEQUENCE_LIST,
+  SEQUENCE_GENERATOR,
+  SEQUENCE_MAP,
+  SEQUENCE_FILTER,
+  SEQUENCE_TAKE
+};
+
+// lazy sequence
+// a sequence only describes how to produce its items, nothing is computed until it is consumed by an iterator
+// sequences are immutable, and shared between generics using refCount
+// count: the length of a range, or the number of items kept by take
+// p_list: the items of a list sequence, or the arguments of a generator
+typedef struct Sequence {
+  int refCount;
+  enum SequenceKind kind;
+  struct Sequence *p_source;
+  Generic *p_func;
+  List *p_list;
+  int count;
+} Sequence;
+
+// state of a single pass over a sequence, with one iterator per stage of the sequence
+// index: the number of items pulled from the source so far
+// p_coroutine: the running generator function, with the scope and line it was started from
+typedef struct SequenceIterator {
+  Sequence *p_seq;
+  struct SequenceIterator *p_source;
+  int index;
+  Coroutine *p_coroutine;
+  Scope *p_scope;
+  int lineNumber;
+} SequenceIterator;
+
+// prototypes
+Sequence *Sequence_range(int);
+Sequence *Sequence_fromList(List *);
+Sequence *Sequence_generator(Generic *, List *);
+Sequence *Sequence_map(Sequence *, Generic *);
+Sequence *Sequence_filter(Sequence *, Generic *);
+Sequence *Sequence_take(Sequence *, int);
+Sequence *Sequence_copy(Sequence *);
+void Sequence_free(Sequence *);
+List *Sequence_collect(Sequence *, Scope *, int);
+SequenceIterator *SequenceIterator_new(Sequence *);
+Generic *SequenceIterator_next(SequenceIterator *, Scope *, int);
+void SequenceIterator_free(SequenceIterator *);
+
+#endif
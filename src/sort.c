@@ -0,0 +1,267 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "sort.h"
+
+// lists shorter than this are sorted with insertion sort
+#define SORT_SMALL 24
+
+/* radix sort */
+// packed numbers are sorted with an LSD radix sort, one byte per pass
+// numbers are first mapped to unsigned keys which sort in the same order
+// passes where every key has the same byte are skipped, so small ranges of numbers only take a pass or two
+
+// sorts length 32 bit keys, using buf as scratch space
+void radixSort32(unsigned int *keys, unsigned int *buf, int length) {
+  int counts[4][256] = {{0}};
+
+  // count every byte in one pass over the keys
+  for (int i = 0; i < length; i++) {
+    for (int pass = 0; pass < 4; pass++) counts[pass][(keys[i] >> (pass * 8)) & 0xff]++;
+  }
+
+  unsigned int *p_src = keys;
+  unsigned int *p_dst = buf;
+
+  for (int pass = 0; pass < 4; pass++) {
+    int shift = pass * 8;
+    if (counts[pass][(p_src[0] >> shift) & 0xff] == length) continue;
+
+    // turn counts into offsets
+    int offsets[256];
+    int total = 0;
+    for (int i = 0; i < 256; i++) {
+      offsets[i] = total;
+      total += counts[pass][i];
+    }
+
+    for (int i = 0; i < length; i++) p_dst[offsets[(p_src[i] >> shift) & 0xff]++] = p_src[i];
+
+    unsigned int *p_temp = p_src;
+    p_src = p_dst;
+    p_dst = p_temp;
+  }
+
+  if (p_src != keys) memcpy(keys, p_src, sizeof(unsigned int) * length);
+}
+
+// sorts length 64 bit keys, using buf as scratch space
+void radixSort64(unsigned long long *keys, unsigned long long *buf, int length) {
+  int counts[8][256] = {{0}};
+
+  for (int i = 0; i < length; i++) {
+    for (int pass = 0; pass < 8; pass++) counts[pass][(keys[i] >> (pass * 8)) & 0xff]++;
+  }
+
+  unsigned long long *p_src = keys;
+  unsigned long long *p_dst = buf;
+
+  for (int pass = 0; pass < 8; pass++) {
+    int shift = pass * 8;
+    if (counts[pass][(p_src[0] >> shift) & 0xff] == length) continue;
+
+    int offsets[256];
+    int total = 0;
+    for (int i = 0; i < 256; i++) {
+      offsets[i] = total;
+      total += counts[pass][i];
+    }
+
+    for (int i = 0; i < length; i++) p_dst[offsets[(p_src[i] >> shift) & 0xff]++] = p_src[i];
+
+    unsigned long long *p_temp = p_src;
+    p_src = p_dst;
+    p_dst = p_temp;
+  }
+
+  if (p_src != keys) memcpy(keys, p_src, sizeof(unsigned long long) * length);
+}
+
+// sorts length ints in place
+void Sort_ints(int *vals, int length) {
+  if (length < SORT_SMALL) {
+    for (int i = 1; i < length; i++) {
+      int curr = vals[i];
+      int j = i;
+      for (; j > 0 && vals[j - 1] > curr; j--) vals[j] = vals[j - 1];
+      vals[j] = curr;
+    }
+    return;
+  }
+
+  unsigned int *keys = (unsigned int *) malloc(sizeof(unsigned int) * length);
+  unsigned int *buf = (unsigned int *) malloc(sizeof(unsigned int) * length);
+
+  // flipping the sign bit puts negative numbers first
+  for (int i = 0; i < length; i++) keys[i] = ((unsigned int) vals[i]) ^ 0x80000000u;
+  radixSort32(keys, buf, length);
+  for (int i = 0; i < length; i++) vals[i] = (int) (keys[i] ^ 0x80000000u);
+
+  free(keys);
+  free(buf);
+}
+
+// sorts length floats in place
+void Sort_floats(double *vals, int length) {
+  if (length < SORT_SMALL) {
+    for (int i = 1; i < length; i++) {
+      double curr = vals[i];
+      int j = i;
+      for (; j > 0 && vals[j - 1] > curr; j--) vals[j] = vals[j - 1];
+      vals[j] = curr;
+    }
+    return;
+  }
+
+  unsigned long long *keys = (unsigned long long *) malloc(sizeof(unsigned long long) * length);
+  unsigned long long *buf = (unsigned long long *) malloc(sizeof(unsigned long long) * length);
+
+  // positive floats sort like their bits once the sign bit is set
+  // negative floats sort in reverse, so all of their bits are flipped
+  for (int i = 0; i < length; i++) {
+    unsigned long long bits;
+    memcpy(&bits, &vals[i], sizeof(bits));
+    keys[i] = (bits >> 63) ? ~bits : bits ^ 0x8000000000000000ULL;
+  }
+
+  radixSort64(keys, buf, length);
+
+  for (int i = 0; i < length; i++) {
+    unsigned long long bits = (keys[i] >> 63) ? keys[i] ^ 0x8000000000000000ULL : ~keys[i];
+    memcpy(&vals[i], &bits, sizeof(bits));
+  }
+
+  free(keys);
+  free(buf);
+}
+
+/* key sorts */
+// returns a negative number if a goes before b, a positive number if b goes before a, else 0
+int compareKeys(SortKey *a, SortKey *b, bool desc) {
+  int res;
+  if (a->str != NULL) res = strcmp(a->str, b->str);
+  else res = (a->num > b->num) - (a->num < b->num);
+
+  return desc ? -res : res;
+}
+
+void insertionSortKeys(SortKey *keys, int length, bool desc) {
+  for (int i = 1; i < length; i++) {
+    SortKey curr = keys[i];
+    int j = i;
+    for (; j > 0 && compareKeys(&keys[j - 1], &curr, desc) > 0; j--) keys[j] = keys[j - 1];
+    keys[j] = curr;
+  }
+}
+
+void swapKeys(SortKey *a, SortKey *b) {
+  SortKey temp = *a;
+  *a = *b;
+  *b = temp;
+}
+
+// restores the heap property below root, used by heapSortKeys
+void siftDownKeys(SortKey *keys, int root, int length, bool desc) {
+  while (root * 2 + 1 < length) {
+    int child = root * 2 + 1;
+    if (child + 1 < length && compareKeys(&keys[child], &keys[child + 1], desc) < 0) child++;
+    if (compareKeys(&keys[root], &keys[child], desc) >= 0) return;
+
+    swapKeys(&keys[root], &keys[child]);
+    root = child;
+  }
+}
+
+void heapSortKeys(SortKey *keys, int length, bool desc) {
+  for (int i = length / 2 - 1; i >= 0; i--) siftDownKeys(keys, i, length, desc);
+
+  for (int i = length - 1; i > 0; i--) {
+    swapKeys(&keys[0], &keys[i]);
+    siftDownKeys(keys, 0, i, desc);
+  }
+}
+
+// quicksort, which switches to heapsort once depth runs out, to guarantee O(n log n)
+void introSortKeys(SortKey *keys, int length, int depth, bool desc) {
+  while (length > SORT_SMALL) {
+    if (depth == 0) {
+      heapSortKeys(keys, length, desc);
+      return;
+    }
+    depth--;
+
+    // median of three, moved to the front as the pivot
+    int mid = length / 2;
+    if (compareKeys(&keys[mid], &keys[0], desc) < 0) swapKeys(&keys[mid], &keys[0]);
+    if (compareKeys(&keys[length - 1], &keys[0], desc) < 0) swapKeys(&keys[length - 1], &keys[0]);
+    if (compareKeys(&keys[length - 1], &keys[mid], desc) < 0) swapKeys(&keys[length - 1], &keys[mid]);
+    swapKeys(&keys[0], &keys[mid]);
+
+    // hoare partition around keys[0]
+    int i = 0;
+    int j = length;
+    while (true) {
+      do i++; while (i < length && compareKeys(&keys[i], &keys[0], desc) < 0);
+      do j--; while (compareKeys(&keys[j], &keys[0], desc) > 0);
+      if (i >= j) break;
+      swapKeys(&keys[i], &keys[j]);
+    }
+    swapKeys(&keys[0], &keys[j]);
+
+    // recurse into the smaller side, and loop on the larger one
+    if (j < length - j - 1) {
+      introSortKeys(keys, j, depth, desc);
+      keys += j + 1;
+      length -= j + 1;
+    } else {
+      introSortKeys(keys + j + 1, length - j - 1, depth, desc);
+      length = j;
+    }
+  }
+
+  insertionSortKeys(keys, length, desc);
+}
+
+// sorts length keys in place, not preserving the order of equal keys
+void Sort_keys(SortKey *keys, int length, bool desc) {
+  int depth = 0;
+  for (int i = length; i > 1; i >>= 1) depth += 2;
+
+  introSortKeys(keys, length, depth, desc);
+}
+
+// merge sort on keys, using buf (of the same length) as scratch space
+void mergeSortKeys(SortKey *keys, SortKey *buf, int length, bool desc) {
+  if (length <= SORT_SMALL) {
+    insertionSortKeys(keys, length, desc);
+    return;
+  }
+
+  int mid = length / 2;
+  mergeSortKeys(keys, buf, mid, desc);
+  mergeSortKeys(keys + mid, buf, length - mid, desc);
+
+  // already in order
+  if (compareKeys(&keys[mid - 1], &keys[mid], desc) <= 0) return;
+
+  // merge, taking from the left half on ties to keep the sort stable
+  memcpy(buf, keys, sizeof(SortKey) * mid);
+
+  int left = 0;
+  int right = mid;
+  int out = 0;
+
+  while (left < mid && right < length) {
+    if (compareKeys(&keys[right], &buf[left], desc) < 0) keys[out++] = keys[right++];
+    else keys[out++] = buf[left++];
+  }
+
+  while (left < mid) keys[out++] = buf[left++];
+}
+
+// sorts length keys in place, preserving the order of equal keys
+void Sort_keysStable(SortKey *keys, int length, bool desc) {
+  SortKey *buf = (SortKey *) malloc(sizeof(SortKey) * (length / 2 + 1));
+  mergeSortKeys(keys, buf, length, desc);
+  free(buf);
+}
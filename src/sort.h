@@ -0,0 +1,20 @@
+#ifndef SORT_H
+#define SORT_H
+#include <stdbool.h>
+
+// key used to sort boxed items
+// str is NULL for numeric keys, index is the position of the item in the original list
+typedef struct SortKey {
+  double num;
+  char *str;
+  int index;
+} SortKey;
+
+// prototypes
+// all sorts are in place, and ascending unless desc is set
+void Sort_ints(int *, int);
+void Sort_floats(double *, int);
+void Sort_keys(SortKey *, int, bool);
+void Sort_keysStable(SortKey *, int, bool);
+
+#endif
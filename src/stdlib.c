@@ -2,10 +2,13 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
+#include <ctype.h>
 #include <math.h>
+#include <limits.h>
 #include <time.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #include "stdlib.h"
 #include "generic.h"
@@ -13,11 +16,24 @@
 #include "scope.h"
 #include "eval.h"
 #include "list.h"
+#include "map.h"
+#include "vector.h"
+#include "sort.h"
+#include "sequence.h"
+#include "coroutine.h"
 #include "events.h"
 #include "file.h"
 #include "lex.h"
 #include "tokens.h"
 #include "parse.h"
+#include "fuse.h"
+#include "fold.h"
+#include "inline.h"
+#include "pool.h"
+#include "symbol.h"
+#include "channel.h"
+#include "memo.h"
+#include "timer.h"
 
 /* tools, used later in stdlib */
 // validate number of arguments
@@ -56,8 +72,9 @@ void validateType(enum Type allowedTypes[], int typeCount, enum Type type, int a
   bool valid = false;
   
   // check if type is valid
+  // memoized functions can be used anywhere a function can
   for (int i = 0; i < typeCount; i++) {
-    if (type == allowedTypes[i]) {
+    if (type == allowedTypes[i] || (type == TYPE_MEMO && allowedTypes[i] == TYPE_FUNCTION)) {
       valid = true;
       break;
     }
@@ -113,6 +130,184 @@ void validateMin(int *p_val, int min, int argNum, int lineNumber, char* funcName
   }
 }
 
+// validate that a list has at least one item
+void validateNonEmpty(List *p_list, int argNum, int lineNumber, char* funcName) {
+  if (p_list->len == 0) {
+    printf(
+      "Runtime Error @ Line %i: %s function expected a non-empty list for argument #%i, empty list supplied instead.\n", 
+      lineNumber, funcName, argNum
+    );
+
+    exit(0);
+  }
+}
+
+// validate that two lists have the same length
+void validateSameLength(List *p_list1, List *p_list2, int lineNumber, char* funcName) {
+  if (p_list1->len != p_list2->len) {
+    printf(
+      "Runtime Error @ Line %i: %s function expected lists of the same length, lengths %i and %i supplied instead.\n", 
+      lineNumber, funcName, p_list1->len, p_list2->len
+    );
+
+    exit(0);
+  }
+}
+
+// get the list in p_arg in packed storage, throwing an error if any item is not a number
+// returns the list in p_arg itself if already packed, otherwise a new list, released with releaseNumericList
+List *getNumericList(Generic *p_arg, int argNum, int lineNumber, char* funcName) {
+  List *p_list = (List *) p_arg->p_val;
+  if (p_list->storage != LIST_BOXED) return p_list;
+
+  List *res = List_pack(p_list);
+  if (res == NULL) {
+    printf(
+      "Runtime Error @ Line %i: %s function requires a list of integer or float type items for argument #%i.\n", 
+      lineNumber, funcName, argNum
+    );
+
+    exit(0);
+  }
+
+  return res;
+}
+
+// convert a list obtained from getNumericList to float storage
+List *promoteNumericList(List *p_list, Generic *p_arg) {
+  if (p_list->storage == LIST_FLOAT) return p_list;
+
+  List *res = List_toFloats(p_list);
+  if (p_list != p_arg->p_val) List_free(p_list);
+  return res;
+}
+
+// free a list obtained from getNumericList, if it is not owned by p_arg
+void releaseNumericList(List *p_list, Generic *p_arg) {
+  if (p_list != p_arg->p_val) List_free(p_list);
+}
+
+// fill key with the value of item to sort by
+// all keys in one sort must be numbers, or all must be strings (p_strings is set by the first key)
+void getSortKey(Generic *p_item, SortKey *p_key, int index, bool *p_strings, int lineNumber, char *funcName) {
+  enum Type allowedTypes[] = {TYPE_INT, TYPE_FLOAT, TYPE_STRING};
+  bool valid = false;
+  for (int i = 0; i < 3; i++) valid = valid || p_item->type == allowedTypes[i];
+
+  if (!valid) {
+    printf(
+      "Runtime Error @ Line %i: %s function can only compare integer, float or string type, %s type supplied instead.\n", 
+      lineNumber, funcName, getTypeString(p_item->type)
+    );
+    exit(0);
+  }
+
+  if (index == 0) *p_strings = p_item->type == TYPE_STRING;
+
+  if (*p_strings != (p_item->type == TYPE_STRING)) {
+    printf(
+      "Runtime Error @ Line %i: %s function can not compare string type with integer or float type.\n", 
+      lineNumber, funcName
+    );
+    exit(0);
+  }
+
+  p_key->index = index;
+  p_key->str = p_item->type == TYPE_STRING ? *((char **) p_item->p_val) : NULL;
+  p_key->num = p_item->type == TYPE_FLOAT 
+    ? *((double *) p_item->p_val) 
+    : p_item->type == TYPE_INT ? *((int *) p_item->p_val) : 0;
+}
+
+// returns a new list, with the items of p_list in the order given by keys
+List *permuteList(List *p_list, SortKey *keys) {
+  List *res = List_alloc(p_list->storage, p_list->len);
+
+  for (int i = 0; i < p_list->len; i++) {
+    int index = keys[i].index;
+    if (p_list->storage == LIST_INT) res->ints[i] = p_list->ints[index];
+    else if (p_list->storage == LIST_FLOAT) res->floats[i] = p_list->floats[index];
+    else res->vals[i] = Generic_copy(p_list->vals[index]);
+  }
+
+  return res;
+}
+
+// returns a sorted copy of a list, used by sort and sort_desc
+// packed lists are radix sorted, lists of strings use introsort
+// lists mixing integers and floats use a stable merge sort, so that equal items keep their order (ie. 1 and 1.0)
+List *sortList(List *p_list, bool desc, int lineNumber, char *funcName) {
+  if (p_list->storage != LIST_BOXED) {
+    List *res = List_copy(p_list);
+
+    if (res->storage == LIST_INT) {
+      Sort_ints(res->ints, res->len);
+      if (desc) {
+        for (int i = 0; i < res->len / 2; i++) {
+          int temp = res->ints[i];
+          res->ints[i] = res->ints[res->len - 1 - i];
+          res->ints[res->len - 1 - i] = temp;
+        }
+      }
+    } else {
+      Sort_floats(res->floats, res->len);
+      if (desc) {
+        for (int i = 0; i < res->len / 2; i++) {
+          double temp = res->floats[i];
+          res->floats[i] = res->floats[res->len - 1 - i];
+          res->floats[res->len - 1 - i] = temp;
+        }
+      }
+    }
+
+    return res;
+  }
+
+  SortKey *keys = (SortKey *) malloc(sizeof(SortKey) * (p_list->len + 1));
+  bool strings = false;
+
+  for (int i = 0; i < p_list->len; i++) {
+    getSortKey(p_list->vals[i], &keys[i], i, &strings, lineNumber, funcName);
+  }
+
+  if (strings) Sort_keys(keys, p_list->len, desc);
+  else Sort_keysStable(keys, p_list->len, desc);
+
+  List *res = permuteList(p_list, keys);
+  free(keys);
+  return res;
+}
+
+// returns a new string generic, holding a copy of the length chars at str
+Generic *newString(char *str, size_t length) {
+  char *res = (char *) malloc(sizeof(char) * (length + 1));
+  memcpy(res, str, length);
+  res[length] = '\0';
+
+  char **p_res = (char **) malloc(sizeof(char *));
+  *p_res = res;
+
+  return Generic_new(TYPE_STRING, p_res, 0);
+}
+
+// returns a pointer to the first occurence of needle in the length chars at str, or NULL if not found
+// candidates are found with memchr on the first char of needle, which is vectorized by the c library
+char *findSubstring(char *str, size_t length, char *needle, size_t needleLength) {
+  if (needleLength == 0) return str;
+
+  char *p_end = str + length;
+  char *p_curr = str;
+
+  while ((size_t) (p_end - p_curr) >= needleLength) {
+    p_curr = memchr(p_curr, needle[0], (p_end - p_curr) - needleLength + 1);
+    if (p_curr == NULL) return NULL;
+    if (memcmp(p_curr + 1, needle + 1, needleLength - 1) == 0) return p_curr;
+    p_curr++;
+  }
+
+  return NULL;
+}
+
 // applys a func, given arguments
 // used for callbacks from the standard library
 Generic *applyFunc(Generic *func, Scope *p_scope, Generic *args[], int length, int lineNumber) {
@@ -183,6 +378,13 @@ Generic *applyFunc(Generic *func, Scope *p_scope, Generic *args[], int length, i
     
     return res;
 
+  } else if (func->type == TYPE_MEMO) {
+    // memoized func case, Memo_apply frees unreferenced args
+    Generic *res = Memo_apply((Memo *) func->p_val, p_scope, args, length, lineNumber);
+    if (func->refCount == 0) Generic_free(func);
+
+    return res;
+
   } else {
     printf(
       "Runtime Error @ Line %i: Attempted to call %s instead of function.\n", 
@@ -192,15 +394,125 @@ Generic *applyFunc(Generic *func, Scope *p_scope, Generic *args[], int length, i
   }
 }
 
+// seed for (random), set once in newGlobal
+unsigned long long randomSeed = 0;
+
+// number of threads that have used (random), so every thread starts at a different state
+unsigned long long randomStreams = 0;
+
+// state of (random), one per thread so that threads never share a generator
+__thread unsigned long long randomState = 0;
+__thread bool randomSeeded = false;
+
+// returns a random double in [0, 1) (splitmix64)
+double nextRandom() {
+  if (!randomSeeded) {
+    randomState = randomSeed + __atomic_fetch_add(&randomStreams, 1, __ATOMIC_RELAXED) * 0xd1b54a32d192ed03ULL;
+    randomSeeded = true;
+  }
+
+  unsigned long long z = (randomState += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  z ^= z >> 31;
+
+  // top 53 bits fill the mantissa
+  return (z >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// returns p_time, an integer or float number of seconds, in nanoseconds (negative times are 0)
+long long getNanoseconds(Generic *p_time) {
+  double seconds = p_time->type == TYPE_INT ? *((int *) p_time->p_val) : *((double *) p_time->p_val);
+  return (long long) fmin(fmax(ceil(seconds * 1e9), 0), 1e18);
+}
+
+// waits until deadline (see Timer_now), or forever if it is -1, applying timers in p_scope as they become due
+// if readEvents is set, returns the first event received, or an empty string once deadline is reached (result is malloc)
+// readEvents requires raw mode to be enabled (see enableRaw)
+// else returns NULL once deadline is reached, or if deadline is -1, once there are no timers left
+char *runTimers(Scope *p_scope, long long deadline, bool readEvents, int lineNumber) {
+  while (true) {
+    // apply every timer which is due
+    // event holds raw mode while it waits, which is left while timers run, so that they print and exit as usual
+    long long now = Timer_now();
+    bool leftRaw = false;
+    Timer *p_timer;
+    while ((p_timer = Timer_takeDue(now)) != NULL) {
+      if (readEvents && !leftRaw) {
+        disableRaw();
+        leftRaw = true;
+      }
+
+      Generic *res = applyFunc(p_timer->p_func, p_scope, NULL, 0, lineNumber);
+      if (res->refCount == 0) Generic_free(res);
+      Timer_finish(p_timer, Timer_now());
+    }
+    if (leftRaw) enableRaw();
+
+    // wait until the deadline, or the next timer, whichever is first
+    long long until = deadline;
+    long long nextDue = Timer_nextDue();
+    if (nextDue != -1 && (until == -1 || nextDue < until)) until = nextDue;
+
+    if (readEvents) {
+      // rounded up to the next millisecond, so that timers are never woken for early
+      int timeout = -1;
+      if (until != -1) timeout = (int) fmin(fmax(ceil((until - Timer_now()) / 1e6), 0), INT_MAX);
+
+      char *res = event(timeout);
+      if (res[0] != '\0' || (deadline != -1 && Timer_now() >= deadline)) return res;
+      free(res);
+    } else {
+      if (until == -1) return NULL;
+      Timer_sleepUntil(until);
+      if (deadline != -1 && Timer_now() >= deadline) return NULL;
+    }
+  }
+}
+
 /* IO */
+// default size of stdout's buffer, in bytes
+#define OUTPUT_BUFFER_SIZE (64 * 1024)
+
+// output is written into stdout's buffer, which is written out once it fills, before reading input, and at exit
+// when stdout is a terminal, it is also flushed after each print, so that output shows up as it is printed
+bool flushEachPrint = false;
+
+// sets up stdout's buffer, before anything is printed
+// its size can be set with the CRUMB_OUTPUT_BUFFER environment variable (0 writes output as it is printed)
+void initOutput() {
+  char *size = getenv("CRUMB_OUTPUT_BUFFER");
+  int bufferSize = size != NULL ? atoi(size) : OUTPUT_BUFFER_SIZE;
+
+  if (bufferSize > 0) setvbuf(stdout, NULL, _IOFBF, bufferSize);
+  else setvbuf(stdout, NULL, _IONBF, 0);
+
+  flushEachPrint = isatty(STDOUT_FILENO);
+}
+
 // (print args...)
 // prints given arguments
 Generic *StdLib_print(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  // hold stdout for the whole print, so that prints from other threads are not interleaved
+  flockfile(stdout);
+
   for (int i = 0; i < length; i++) {
     Generic_print(args[i]);
     if (i < length - 1) printf(" ");
   }
 
+  if (flushEachPrint) fflush(stdout);
+  funlockfile(stdout);
+
+  return Generic_new(TYPE_VOID, NULL, 0);
+}
+
+// (flush)
+// writes out any buffered output
+Generic *StdLib_flush(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(0, 0, length, lineNumber);
+  fflush(stdout);
+
   return Generic_new(TYPE_VOID, NULL, 0);
 }
 
@@ -209,11 +521,11 @@ Generic *StdLib_print(Scope *p_scope, Generic *args[], int length, int lineNumbe
 Generic *StdLib_input(Scope *p_scope, Generic *args[], int length, int lineNumber) {
   validateArgCount(0, 0, length, lineNumber);
 
+  // write out buffered output (ie. a prompt) before reading
+  fflush(stdout);
+
   // eat through anything in the input buffer
-  enableRaw();
-  char eat = readChar();
-  while (eat != '\0') eat = readChar();
-  disableRaw();
+  discardInput();
 
   // enable echo
   tcsetattr(STDIN_FILENO, TCSAFLUSH, &orig_termios);
@@ -242,16 +554,225 @@ Generic *StdLib_input(Scope *p_scope, Generic *args[], int length, int lineNumbe
   return Generic_new(TYPE_STRING, p_res, 0);
 }
 
+// frame drawn by the last render, so that the next one only draws what changed
+// shared by every thread, so all access goes through renderLock
+// renderedAt is the resize count the frame was drawn at (see getResizeCount), -1 if nothing was drawn
+pthread_mutex_t renderLock = PTHREAD_MUTEX_INITIALIZER;
+char **renderedRows = NULL;
+int renderedRowCount = 0;
+int renderedAt = -1;
+
+// output of a render, grown as it is written
+typedef struct RenderBuffer {
+  char *chars;
+  int length;
+  int capacity;
+} RenderBuffer;
+
+// appends length chars of str to p_buffer
+void appendRender(RenderBuffer *p_buffer, char *str, int length) {
+  if (p_buffer->length + length > p_buffer->capacity) {
+    while (p_buffer->length + length > p_buffer->capacity) p_buffer->capacity *= 2;
+    p_buffer->chars = (char *) realloc(p_buffer->chars, sizeof(char) * p_buffer->capacity);
+  }
+
+  memcpy(&p_buffer->chars[p_buffer->length], str, length);
+  p_buffer->length += length;
+}
+
+// appends an escape code moving the cursor to row and column (from 1) to p_buffer
+void appendCursorMove(RenderBuffer *p_buffer, int row, int column) {
+  char code[32];
+  appendRender(p_buffer, code, sprintf(code, "\e[%i;%iH", row, column));
+}
+
+// returns the number of columns the first length chars of str take up in the terminal
+// every utf-8 char is assumed to take up one column, and escape codes none
+int getDisplayWidth(char *str, int length) {
+  int res = 0;
+
+  for (int i = 0; i < length; i++) {
+    if (str[i] == '\e' && i + 1 < length && str[i + 1] == '[') {
+      // control sequence, ended by a char in the range of 0x40 - 0x7E
+      i += 2;
+      while (i < length && !(64 <= str[i] && str[i] <= 126)) i++;
+    } else if ((str[i] & 0xC0) != 0x80) {
+      // count the first byte of each utf-8 char
+      res++;
+    }
+  }
+
+  return res;
+}
+
+// throws an error for a frame passed to render whose rows are not strings, or lists of strings
+void handleFrameError(int lineNumber) {
+  printf(
+    "Runtime Error @ Line %i: render function requires a list of string type or list type rows for argument #1, where lists only hold strings.\n", 
+    lineNumber
+  );
+  exit(0);
+}
+
+// returns a row of a frame passed to render as a new string
+// a row is a string, or a list of strings (ie. cells) which are joined
+char *getFrameRow(Generic *p_row, int lineNumber) {
+  if (p_row->type == TYPE_STRING) {
+    char *res = (char *) malloc(sizeof(char) * (strlen(*((char **) p_row->p_val)) + 1));
+    strcpy(res, *((char **) p_row->p_val));
+    return res;
+  }
+
+  // lists of numbers are packed, so only boxed lists can hold strings
+  if (p_row->type != TYPE_LIST) handleFrameError(lineNumber);
+  List *p_cells = (List *) p_row->p_val;
+  if (p_cells->storage != LIST_BOXED && p_cells->len > 0) handleFrameError(lineNumber);
+
+  RenderBuffer row = {(char *) malloc(sizeof(char) * 64), 0, 64};
+
+  for (int i = 0; i < p_cells->len; i++) {
+    Generic *p_cell = p_cells->vals[i];
+    if (p_cell->type != TYPE_STRING) handleFrameError(lineNumber);
+
+    appendRender(&row, *((char **) p_cell->p_val), strlen(*((char **) p_cell->p_val)));
+  }
+
+  appendRender(&row, "", 1);
+  return row.chars;
+}
+
+// appends what is needed to redraw old as new, on row of the terminal, to p_buffer
+// plain rows only redraw the span of chars that changed, rows holding escape codes are redrawn whole
+void appendRowChange(RenderBuffer *p_buffer, int row, char *old, char *new) {
+  int oldLength = strlen(old);
+  int newLength = strlen(new);
+  int oldWidth = getDisplayWidth(old, oldLength);
+  int newWidth = getDisplayWidth(new, newLength);
+
+  // start of the changed span, and end in new
+  int start = 0;
+  int end = newLength;
+
+  if (strchr(old, '\e') == NULL && strchr(new, '\e') == NULL) {
+    // skip the common prefix, back to the start of a char
+    while (start < oldLength && start < newLength && old[start] == new[start]) start++;
+    while (start > 0 && (new[start] & 0xC0) == 0x80) start--;
+
+    // if the rows are as wide, the common suffix is in the same columns, so skip it too (forward to the start of a char)
+    if (oldWidth == newWidth) {
+      int suffix = 0;
+      while (
+        suffix < oldLength - start && suffix < newLength - start
+        && old[oldLength - 1 - suffix] == new[newLength - 1 - suffix]
+      ) suffix++;
+
+      end = newLength - suffix;
+      while (end < newLength && (new[end] & 0xC0) == 0x80) end++;
+    }
+  }
+
+  appendCursorMove(p_buffer, row, getDisplayWidth(new, start) + 1);
+  appendRender(p_buffer, &new[start], end - start);
+
+  // clear what is left of the old row
+  if (newWidth < oldWidth) appendRender(p_buffer, "\e[K", 3);
+}
+
+// (render frame) or (render frame redraw)
+// draws frame, a list of rows, from the top left of the terminal
+// only the parts of rows which changed since the last render are drawn, in a single write
+// the whole frame is drawn if redraw is 1, on the first render, or once the terminal is resized
+Generic *StdLib_render(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 2, length, lineNumber);
+
+  enum Type allowedTypes1[] = {TYPE_LIST};
+  validateType(allowedTypes1, 1, args[0]->type, 1, lineNumber, "render");
+
+  bool redraw = false;
+  if (length == 2) {
+    enum Type allowedTypes2[] = {TYPE_INT};
+    validateType(allowedTypes2, 1, args[1]->type, 2, lineNumber, "render");
+    validateBinary((int *) args[1]->p_val, 2, lineNumber, "render");
+    redraw = *((int *) args[1]->p_val) == 1;
+  }
+
+  // get rows, lists of numbers are packed, so only boxed lists can hold rows
+  List *p_frame = (List *) args[0]->p_val;
+  if (p_frame->storage != LIST_BOXED && p_frame->len > 0) handleFrameError(lineNumber);
+
+  int rowCount = p_frame->len;
+  char **rows = (char **) malloc(sizeof(char *) * (rowCount > 0 ? rowCount : 1));
+  for (int i = 0; i < rowCount; i++) rows[i] = getFrameRow(p_frame->vals[i], lineNumber);
+
+  pthread_mutex_lock(&renderLock);
+
+  int resizeCount = getResizeCount();
+  if (renderedAt != resizeCount) redraw = true;
+
+  RenderBuffer output = {(char *) malloc(sizeof(char) * 1024), 0, 1024};
+
+  if (redraw) {
+    // clear the screen, and draw every row
+    appendRender(&output, "\e[H\e[2J", 7);
+    for (int i = 0; i < rowCount; i++) {
+      appendCursorMove(&output, i + 1, 1);
+      appendRender(&output, rows[i], strlen(rows[i]));
+    }
+  } else {
+    // draw rows which changed, and clear rows which are no longer in the frame
+    for (int i = 0; i < rowCount; i++) {
+      char *old = i < renderedRowCount ? renderedRows[i] : "";
+      if (strcmp(old, rows[i]) != 0) appendRowChange(&output, i + 1, old, rows[i]);
+    }
+
+    for (int i = rowCount; i < renderedRowCount; i++) {
+      appendCursorMove(&output, i + 1, 1);
+      appendRender(&output, "\e[K", 3);
+    }
+  }
+
+  // leave the cursor after the last row, as if the frame was printed
+  if (output.length > 0 && rowCount > 0) {
+    appendCursorMove(&output, rowCount, getDisplayWidth(rows[rowCount - 1], strlen(rows[rowCount - 1])) + 1);
+  }
+
+  // write buffered output first, then the frame in one write
+  flockfile(stdout);
+  fflush(stdout);
+
+  int written = 0;
+  while (written < output.length) {
+    int count = write(STDOUT_FILENO, &output.chars[written], output.length - written);
+    if (count <= 0) break;
+    written += count;
+  }
+
+  funlockfile(stdout);
+  free(output.chars);
+
+  // keep the frame for the next render
+  for (int i = 0; i < renderedRowCount; i++) free(renderedRows[i]);
+  free(renderedRows);
+
+  renderedRows = rows;
+  renderedRowCount = rowCount;
+  renderedAt = resizeCount;
+
+  pthread_mutex_unlock(&renderLock);
+
+  return Generic_new(TYPE_VOID, NULL, 0);
+}
+
 // (columns)
 // returns number of columns in terminal
 Generic *StdLib_columns(Scope *p_scope, Generic *args[], int length, int lineNumber) {
-  // get current dimensions
-  struct winsize w;
-  ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
+  // get current dimensions, cached until the terminal is resized
+  int terminalRows, terminalColumns;
+  getTerminalSize(&terminalRows, &terminalColumns);
 
   // create pointer to rows
   int *rows = (int *) malloc(sizeof(int));
-  *rows = w.ws_col;
+  *rows = terminalColumns;
 
   // return generic
   return Generic_new(TYPE_INT, rows, 0);
@@ -260,13 +781,13 @@ Generic *StdLib_columns(Scope *p_scope, Generic *args[], int length, int lineNum
 // (rows)
 // returns number of rows in terminal
 Generic *StdLib_rows(Scope *p_scope, Generic *args[], int length, int lineNumber) {
-  // get current dimensions
-  struct winsize w;
-  ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
+  // get current dimensions, cached until the terminal is resized
+  int terminalRows, terminalColumns;
+  getTerminalSize(&terminalRows, &terminalColumns);
 
   // create pointer to rows
   int *rows = (int *) malloc(sizeof(int));
-  *rows = w.ws_row;
+  *rows = terminalRows;
 
   // return generic
   return Generic_new(TYPE_INT, rows, 0);
@@ -313,37 +834,24 @@ Generic *StdLib_write_file(Scope *p_scope, Generic *args[], int length, int line
 Generic *StdLib_event(Scope *p_scope, Generic *args[], int length, int lineNumber) {
   validateArgCount(0, 1, length, lineNumber);
 
-  // find the number of deciseconds to block
-  int decisecondsBlock;
+  // find when to stop blocking, where -1 blocks until an event is received
+  long long deadline = -1;
   if (length == 1) {
     enum Type allowedTypes[] = {TYPE_FLOAT, TYPE_INT};
     validateType(allowedTypes, 2, args[0]->type, 1, lineNumber, "event");
-  
-    if (args[0]->type == TYPE_INT) {
-      decisecondsBlock = *((int *) args[0]->p_val) * 10;
-    }
-    if (args[0]->type == TYPE_FLOAT) {
-      decisecondsBlock = (int) ceilf(*((double *) args[0]->p_val) * 10);
-    }
+    deadline = Timer_now() + getNanoseconds(args[0]);
   }
 
-  char **p_res = (char **) malloc(sizeof(char *));
-
-  int i = 0;
-  while (length == 0 || i < decisecondsBlock) {
-    if (i != 0) {
-      free(*p_res);
-    }
-    *p_res = event();
+  // write out buffered output before reading
+  fflush(stdout);
 
-    // if an event is received
-    if (strcmp(*p_res, "") != 0) {
-      return Generic_new(TYPE_STRING, p_res, 0);
-    }
+  // raw is enabled once for the whole wait, rather than for every read
+  // timers which become due while waiting are applied
+  enableRaw();
+  char **p_res = (char **) malloc(sizeof(char *));
+  *p_res = runTimers(p_scope, deadline, true, lineNumber);
+  disableRaw();
 
-    i += 1;
-  }
-  
   return Generic_new(TYPE_STRING, p_res, 0);
 }
 
@@ -380,30 +888,18 @@ Generic *StdLib_use(Scope *p_scope, Generic *args[], int length, int lineNumber)
       exit(0); 
     }
 
-    // create initial token
-    Token *p_headToken = (Token *) malloc(sizeof(Token));
-    p_headToken->lineNumber = 1;
-    p_headToken->type = TOK_START;
-    p_headToken->val = NULL;
-    p_headToken->p_next = NULL;
-
-    // lex
-    int tokenCount = lex(p_headToken, code, strlen(code));
-
-    // parse
-    AstNode *p_headAstNode = parseProgram(p_headToken, tokenCount);
-
-    // eval and free
-    Generic_free(eval(p_headAstNode, p_newScope, 0));
+    // lex and parse
+    AstNode *p_headAstNode = parseCode(code, strlen(code));
+    fuse(p_headAstNode);
+    inlineFunctions(p_headAstNode);
+    fold(p_headAstNode);
 
-    // free memory
-    // code
+    // free code, which the ast no longer needs
     free(code);
     code = NULL;
 
-    // tokens
-    Token_free(p_headToken);
-    p_headToken = NULL;
+    // eval and free
+    Generic_free(eval(p_headAstNode, p_newScope, 0));
 
     // ast
     AstNode_free(p_headAstNode);
@@ -831,7 +1327,7 @@ Generic *StdLib_random(Scope *p_scope, Generic *args[], int length, int lineNumb
   validateArgCount(0, 0, length, lineNumber);
 
   double *p_res = (double *) malloc(sizeof(double));
-  *p_res = (double) rand() / (double) RAND_MAX;
+  *p_res = nextRandom();
   
   return Generic_new(TYPE_FLOAT, p_res, 0);
 }
@@ -844,12 +1340,31 @@ Generic *StdLib_random(Scope *p_scope, Generic *args[], int length, int lineNumb
 Generic *StdLib_loop(Scope *p_scope, Generic *args[], int length, int lineNumber) {
   validateArgCount(2, 2, length, lineNumber);
 
-  enum Type allowedTypes1[] = {TYPE_INT};
+  enum Type allowedTypes1[] = {TYPE_INT, TYPE_SEQUENCE};
   enum Type allowedTypes2[] = {TYPE_NATIVEFUNCTION, TYPE_FUNCTION};
 
-  validateType(allowedTypes1, 1, args[0]->type, 1, lineNumber, "loop");
+  validateType(allowedTypes1, 2, args[0]->type, 1, lineNumber, "loop");
   validateType(allowedTypes2, 2, args[1]->type, 2, lineNumber, "loop");
 
+  // sequence case, pass each item to cb instead of the index
+  if (args[0]->type == TYPE_SEQUENCE) {
+    SequenceIterator *p_iter = SequenceIterator_new((Sequence *) args[0]->p_val);
+    Generic *p_item;
+
+    while ((p_item = SequenceIterator_next(p_iter, p_scope, lineNumber)) != NULL) {
+      Generic *newArgs[1] = {p_item};
+      Generic *res = applyFunc(args[1], p_scope, newArgs, 1, lineNumber);
+
+      if (res->type != TYPE_VOID) {
+        SequenceIterator_free(p_iter);
+        return res;
+      } else Generic_free(res);
+    }
+
+    SequenceIterator_free(p_iter);
+    return Generic_new(TYPE_VOID, NULL, 0);
+  }
+
   validateMin(args[0]->p_val, 0, 1, lineNumber, "loop");
   
   // loop
@@ -960,20 +1475,73 @@ Generic *StdLib_if(Scope *p_scope, Generic *args[], int length, int lineNumber)
 }
 
 // (wait t)
-// waits t seconds
+// waits t seconds, applying timers which become due in that time
 Generic *StdLib_wait(Scope *p_scope, Generic *args[], int length, int lineNumber) {
   validateArgCount(1, 1, length, lineNumber);
   enum Type allowedTypes[] = {TYPE_INT, TYPE_FLOAT};
   validateType(allowedTypes, 2, args[0]->type, 1, lineNumber, "wait");
-  int initialTime = clock();
-  while (
-    (((double) clock()) - ((double) initialTime)) / ((double) CLOCKS_PER_SEC)
-    < (args[0]->type == TYPE_INT ? *((int *) args[0]->p_val) : *((double *) args[0]->p_val))
-  ) {}
+
+  runTimers(p_scope, Timer_now() + getNanoseconds(args[0]), false, lineNumber);
   
   return Generic_new(TYPE_VOID, NULL, 0);
 }
 
+// (set_timeout fn time)
+// applies fn once, after time seconds, returning the id of the timer
+Generic *StdLib_set_timeout(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes1[] = {TYPE_FUNCTION, TYPE_NATIVEFUNCTION};
+  enum Type allowedTypes2[] = {TYPE_INT, TYPE_FLOAT};
+  validateType(allowedTypes1, 2, args[0]->type, 1, lineNumber, "set_timeout");
+  validateType(allowedTypes2, 2, args[1]->type, 2, lineNumber, "set_timeout");
+
+  int *p_res = (int *) malloc(sizeof(int));
+  *p_res = Timer_add(args[0], getNanoseconds(args[1]), -1);
+  return Generic_new(TYPE_INT, p_res, 0);
+}
+
+// (set_interval fn time)
+// applies fn every time seconds, returning the id of the timer
+Generic *StdLib_set_interval(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes1[] = {TYPE_FUNCTION, TYPE_NATIVEFUNCTION};
+  enum Type allowedTypes2[] = {TYPE_INT, TYPE_FLOAT};
+  validateType(allowedTypes1, 2, args[0]->type, 1, lineNumber, "set_interval");
+  validateType(allowedTypes2, 2, args[1]->type, 2, lineNumber, "set_interval");
+
+  // an interval of 0 would never let the program wait, so intervals are at least 1 ms
+  long long interval = getNanoseconds(args[1]);
+  if (interval < 1000000) interval = 1000000;
+
+  int *p_res = (int *) malloc(sizeof(int));
+  *p_res = Timer_add(args[0], interval, interval);
+  return Generic_new(TYPE_INT, p_res, 0);
+}
+
+// (clear_timer id)
+// stops the timer with id from being applied again, returning 1 if there was such a timer, else 0
+Generic *StdLib_clear_timer(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_INT};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "clear_timer");
+
+  int *p_res = (int *) malloc(sizeof(int));
+  *p_res = Timer_cancel(*((int *) args[0]->p_val));
+  return Generic_new(TYPE_INT, p_res, 0);
+}
+
+// (run_timers)
+// sleeps, applying timers as they become due, until there are none left
+Generic *StdLib_run_timers(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(0, 0, length, lineNumber);
+
+  runTimers(p_scope, -1, false, lineNumber);
+  return Generic_new(TYPE_VOID, NULL, 0);
+}
+
 /* types */
 // (int x)
 // returns x as an integer, if string, float, or int passed
@@ -1082,19 +1650,32 @@ Generic *StdLib_list(Scope *p_scope, Generic *args[], int length, int lineNumber
 }
 
 // (length list)
-// returns list length
+// returns list length (or the number of keys in a map, or the number of items in a sequence)
 Generic *StdLib_length(Scope *p_scope, Generic *args[], int length, int lineNumber) {
   validateArgCount(1, 1, length, lineNumber);
   
-  enum Type allowedTypes[] = {TYPE_LIST, TYPE_STRING};
-  validateType(allowedTypes, 2, args[0]->type, 1, lineNumber, "length");
+  enum Type allowedTypes[] = {TYPE_LIST, TYPE_STRING, TYPE_MAP, TYPE_SEQUENCE};
+  validateType(allowedTypes, 4, args[0]->type, 1, lineNumber, "length");
 
   // create int
   int *p_res = (int *) malloc(sizeof(int));
 
   // get length and return
   if (args[0]->type == TYPE_LIST) *p_res = List_length((List *) args[0]->p_val);
-  else *p_res = strlen(*((char **) args[0]->p_val));
+  else if (args[0]->type == TYPE_MAP) *p_res = Map_length((Map *) args[0]->p_val);
+  else if (args[0]->type == TYPE_SEQUENCE) {
+    // sequences have to be consumed to be counted
+    SequenceIterator *p_iter = SequenceIterator_new((Sequence *) args[0]->p_val);
+    Generic *p_item;
+
+    *p_res = 0;
+    while ((p_item = SequenceIterator_next(p_iter, p_scope, lineNumber)) != NULL) {
+      Generic_free(p_item);
+      (*p_res)++;
+    }
+
+    SequenceIterator_free(p_iter);
+  } else *p_res = strlen(*((char **) args[0]->p_val));
   return Generic_new(TYPE_INT, p_res, 0);
 }
 
@@ -1431,28 +2012,34 @@ Generic *StdLib_delete(Scope *p_scope, Generic *args[], int length, int lineNumb
 
 // (map list fn)
 // applys fn to every item in list, returns list with results
+// if list is a sequence, returns a sequence which applys fn as items are consumed
 Generic *StdLib_map(Scope *p_scope, Generic *args[], int length, int lineNumber) {
   validateArgCount(2, 2, length, lineNumber);
 
-  enum Type allowedTypes1[] = {TYPE_LIST};
-  validateType(allowedTypes1, 1, args[0]->type, 1, lineNumber, "map");
+  enum Type allowedTypes1[] = {TYPE_LIST, TYPE_SEQUENCE};
+  validateType(allowedTypes1, 2, args[0]->type, 1, lineNumber, "map");
 
   enum Type allowedTypes2[] = {TYPE_FUNCTION, TYPE_NATIVEFUNCTION};
   validateType(allowedTypes2, 2, args[1]->type, 2, lineNumber, "map");
 
-  // create copy of list
-  Generic *res = Generic_copy(args[0]);
-  List *p_list = (List *) (res->p_val);
+  if (args[0]->type == TYPE_SEQUENCE) {
+    return Generic_new(TYPE_SEQUENCE, Sequence_map((Sequence *) args[0]->p_val, args[1]), 0);
+  }
+
+  List *p_list = (List *) (args[0]->p_val);
+
+  // results are collected boxed, and packed by List_wrap if possible
+  Generic **vals = (Generic **) malloc(sizeof(Generic *) * p_list->len);
 
   for (int i = 0; i < p_list->len; i += 1) {
     int *p_i = (int *) malloc(sizeof(int));
     *p_i = i;
 
-    Generic *newArgs[] = {p_list->vals[i], Generic_new(TYPE_INT, p_i, 0)};
-    p_list->vals[i] = applyFunc(args[1], p_scope, newArgs, 2, lineNumber);
+    Generic *newArgs[] = {List_get(p_list, i), Generic_new(TYPE_INT, p_i, 0)};
+    vals[i] = applyFunc(args[1], p_scope, newArgs, 2, lineNumber);
   }
 
-  return res;
+  return Generic_new(TYPE_LIST, List_wrap(vals, p_list->len), 0);
 }
 
 // (reduce list fn acc)
@@ -1461,8 +2048,8 @@ Generic *StdLib_map(Scope *p_scope, Generic *args[], int length, int lineNumber)
 Generic *StdLib_reduce(Scope *p_scope, Generic *args[], int length, int lineNumber) {
   validateArgCount(2, 3, length, lineNumber);
 
-  enum Type allowedTypes1[] = {TYPE_LIST};
-  validateType(allowedTypes1, 1, args[0]->type, 1, lineNumber, "reduce");
+  enum Type allowedTypes1[] = {TYPE_LIST, TYPE_SEQUENCE};
+  validateType(allowedTypes1, 2, args[0]->type, 1, lineNumber, "reduce");
 
   enum Type allowedTypes2[] = {TYPE_FUNCTION, TYPE_NATIVEFUNCTION};
   validateType(allowedTypes2, 2, args[1]->type, 2, lineNumber, "reduce");
@@ -1477,17 +2064,34 @@ Generic *StdLib_reduce(Scope *p_scope, Generic *args[], int length, int lineNumb
     p_acc = Generic_new(TYPE_VOID, NULL, 0);
   }
 
-  // Get list
-  List *p_list = (List *) (args[0]->p_val);
- 
-  // loop on every item
+  // sequences are consumed one item at a time
+  if (args[0]->type == TYPE_SEQUENCE) {
+    SequenceIterator *p_iter = SequenceIterator_new((Sequence *) args[0]->p_val);
+    Generic *p_item;
+
+    for (int i = 0; (p_item = SequenceIterator_next(p_iter, p_scope, lineNumber)) != NULL; i++) {
+      int *p_i = (int *) malloc(sizeof(int));
+      *p_i = i;
+
+      Generic *newArgs[] = {p_acc, p_item, Generic_new(TYPE_INT, p_i, 0)};
+      p_acc = applyFunc(args[1], p_scope, newArgs, 3, lineNumber);
+    }
+
+    SequenceIterator_free(p_iter);
+    return p_acc;
+  }
+
+  // Get list
+  List *p_list = (List *) (args[0]->p_val);
+ 
+  // loop on every item
   for (int i = 0; i < p_list->len; i += 1) {
     // create pointer for index, to create generic for args
     int *p_i = (int *) malloc(sizeof(int));
     *p_i = i;
     
     // apply function
-    Generic *newArgs[] = {p_acc, Generic_copy(p_list->vals[i]), Generic_new(TYPE_INT, p_i, 0)};
+    Generic *newArgs[] = {p_acc, List_get(p_list, i), Generic_new(TYPE_INT, p_i, 0)};
     p_acc = applyFunc(args[1], p_scope, newArgs, 3, lineNumber);
   }
 
@@ -1503,24 +2107,15 @@ Generic *StdLib_range(Scope *p_scope, Generic *args[], int length, int lineNumbe
   validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "range");
   validateMin(args[0]->p_val, 0, 1, lineNumber, "range");
 
-  // make list of arguments to pass to List_new
+  // write directly into a packed int list
   int count = *((int *) args[0]->p_val);
-  Generic *argList[count];
+  List *p_res = List_alloc(LIST_INT, count);
   
   for (int i = 0; i < count; i++) {
-    int *p_i = (int *) malloc(sizeof(int));
-    *p_i = i;
-    argList[i] = Generic_new(TYPE_INT, p_i, 0);
-  }
-
-  Generic *res = Generic_new(TYPE_LIST, List_new(argList, count), 0);
-
-  // free
-  for (int i = 0; i < count; i++) {
-    Generic_free(argList[i]);
+    p_res->ints[i] = i;
   }
 
-  return res;
+  return Generic_new(TYPE_LIST, p_res, 0);
 }
 
 // (find x item)
@@ -1528,8 +2123,27 @@ Generic *StdLib_range(Scope *p_scope, Generic *args[], int length, int lineNumbe
 Generic *StdLib_find(Scope *p_scope, Generic *args[], int length, int lineNumber) {
   validateArgCount(2, 2, length, lineNumber);
 
-  enum Type allowedTypes1[] = {TYPE_STRING, TYPE_LIST};
-  validateType(allowedTypes1, 2, args[0]->type, 1, lineNumber, "find");
+  enum Type allowedTypes1[] = {TYPE_STRING, TYPE_LIST, TYPE_SEQUENCE};
+  validateType(allowedTypes1, 3, args[0]->type, 1, lineNumber, "find");
+
+  if (args[0]->type == TYPE_SEQUENCE) {
+    // sequence case, only consumed up to the first match
+    SequenceIterator *p_iter = SequenceIterator_new((Sequence *) args[0]->p_val);
+    Generic *p_item;
+    int index = -1;
+
+    for (int i = 0; index == -1 && (p_item = SequenceIterator_next(p_iter, p_scope, lineNumber)) != NULL; i++) {
+      if (Generic_is(p_item, args[1])) index = i;
+      Generic_free(p_item);
+    }
+
+    SequenceIterator_free(p_iter);
+    if (index == -1) return Generic_new(TYPE_VOID, NULL, 0);
+
+    int *p_index = (int *) malloc(sizeof(int));
+    *p_index = index;
+    return Generic_new(TYPE_INT, p_index, 0);
+  }
 
   if (args[0]->type == TYPE_STRING) {
 
@@ -1552,27 +2166,1268 @@ Generic *StdLib_find(Scope *p_scope, Generic *args[], int length, int lineNumber
     // list case
     List *p_list = ((List *) args[0]->p_val);
 
-    // for each item
-    for (int i = 0; i < p_list->len; i += 1) {
+    int index = List_find(p_list, args[1]);
 
-      // if found, return index
-      if (Generic_is(p_list->vals[i], args[1])) {
-        int *p_index = (int *) malloc(sizeof(int));
-        *p_index = i;
-        return Generic_new(TYPE_INT, p_index, 0);
-      }
+    // if not found return void
+    if (index == -1) return Generic_new(TYPE_VOID, NULL, 0);
+
+    // if found, return index
+    int *p_index = (int *) malloc(sizeof(int));
+    *p_index = index;
+    return Generic_new(TYPE_INT, p_index, 0);
+  }
+}
+
+/* strings */
+// (split str sep)
+// returns a list of the parts of str between each occurence of sep
+// if sep is empty, returns every char of str
+Generic *StdLib_split(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_STRING};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "split");
+  validateType(allowedTypes, 1, args[1]->type, 2, lineNumber, "split");
+
+  char *str = *((char **) args[0]->p_val);
+  char *sep = *((char **) args[1]->p_val);
+  size_t strLength = strlen(str);
+  size_t sepLength = strlen(sep);
+
+  int capacity = 8;
+  int count = 0;
+  Generic **parts = (Generic **) malloc(sizeof(Generic *) * capacity);
+
+  char *p_start = str;
+  char *p_end = str + strLength;
+
+  while (true) {
+    // an empty separator splits between every char
+    char *p_sep = sepLength == 0
+      ? (p_start + 1 < p_end ? p_start + 1 : NULL)
+      : findSubstring(p_start, p_end - p_start, sep, sepLength);
+
+    if (count == capacity) {
+      capacity *= 2;
+      parts = (Generic **) realloc(parts, sizeof(Generic *) * capacity);
     }
 
-    // if not found return void
-    return Generic_new(TYPE_VOID, NULL, 0);
+    if (p_sep == NULL) {
+      // empty strings split into nothing when splitting into chars
+      if (sepLength != 0 || strLength != 0) parts[count++] = newString(p_start, p_end - p_start);
+      break;
+    }
+
+    parts[count++] = newString(p_start, p_sep - p_start);
+    p_start = p_sep + sepLength;
+  }
+
+  return Generic_new(TYPE_LIST, List_wrap(parts, count), 0);
+}
+
+// (chars str)
+// returns a list of every char in str
+Generic *StdLib_chars(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_STRING};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "chars");
+
+  char *str = *((char **) args[0]->p_val);
+  int strLength = strlen(str);
+
+  Generic **res = (Generic **) malloc(sizeof(Generic *) * (strLength + 1));
+  for (int i = 0; i < strLength; i++) res[i] = newString(&str[i], 1);
+
+  return Generic_new(TYPE_LIST, List_wrap(res, strLength), 0);
+}
+
+// (replace str old new)
+// returns str with every occurence of old replaced by new
+Generic *StdLib_replace(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(3, 3, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_STRING};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "replace");
+  validateType(allowedTypes, 1, args[1]->type, 2, lineNumber, "replace");
+  validateType(allowedTypes, 1, args[2]->type, 3, lineNumber, "replace");
+
+  char *str = *((char **) args[0]->p_val);
+  char *old = *((char **) args[1]->p_val);
+  char *new = *((char **) args[2]->p_val);
+  size_t strLength = strlen(str);
+  size_t oldLength = strlen(old);
+  size_t newLength = strlen(new);
+
+  if (oldLength == 0) return newString(str, strLength);
+
+  // result grows as matches are found, so str is only scanned once
+  size_t capacity = strLength + 1;
+  size_t resLength = 0;
+  char *res = (char *) malloc(sizeof(char) * capacity);
+
+  char *p_start = str;
+  char *p_end = str + strLength;
+
+  while (true) {
+    char *p_match = findSubstring(p_start, p_end - p_start, old, oldLength);
+    size_t chunkLength = (p_match == NULL ? p_end : p_match) - p_start;
+    size_t needed = resLength + chunkLength + (p_match == NULL ? 0 : newLength) + 1;
+
+    if (needed > capacity) {
+      while (needed > capacity) capacity *= 2;
+      res = (char *) realloc(res, sizeof(char) * capacity);
+    }
+
+    memcpy(res + resLength, p_start, chunkLength);
+    resLength += chunkLength;
+
+    if (p_match == NULL) break;
+
+    memcpy(res + resLength, new, newLength);
+    resLength += newLength;
+    p_start = p_match + oldLength;
+  }
+
+  res[resLength] = '\0';
+
+  char **p_res = (char **) malloc(sizeof(char *));
+  *p_res = res;
+
+  return Generic_new(TYPE_STRING, p_res, 0);
+}
+
+// (trim str)
+// returns str without whitespace at the start and end
+Generic *StdLib_trim(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_STRING};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "trim");
+
+  char *p_start = *((char **) args[0]->p_val);
+  char *p_end = p_start + strlen(p_start);
+
+  while (p_start < p_end && isspace((unsigned char) *p_start)) p_start++;
+  while (p_end > p_start && isspace((unsigned char) *(p_end - 1))) p_end--;
+
+  return newString(p_start, p_end - p_start);
+}
+
+// returns a copy of str with every char mapped by convert, used by upper and lower
+Generic *mapChars(Generic *p_str, int (*convert)(int)) {
+  char *str = *((char **) p_str->p_val);
+  size_t strLength = strlen(str);
+
+  Generic *res = newString(str, strLength);
+  char *resStr = *((char **) res->p_val);
+  for (size_t i = 0; i < strLength; i++) resStr[i] = convert((unsigned char) resStr[i]);
+
+  return res;
+}
+
+// (upper str)
+// returns str in upper case
+Generic *StdLib_upper(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_STRING};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "upper");
+
+  return mapChars(args[0], toupper);
+}
+
+// (lower str)
+// returns str in lower case
+Generic *StdLib_lower(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_STRING};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "lower");
+
+  return mapChars(args[0], tolower);
+}
+
+// (starts_with str prefix)
+// returns 1 if str starts with prefix, else returns 0
+Generic *StdLib_starts_with(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_STRING};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "starts_with");
+  validateType(allowedTypes, 1, args[1]->type, 2, lineNumber, "starts_with");
+
+  char *str = *((char **) args[0]->p_val);
+  char *prefix = *((char **) args[1]->p_val);
+
+  int *p_res = (int *) malloc(sizeof(int));
+  *p_res = strncmp(str, prefix, strlen(prefix)) == 0;
+  return Generic_new(TYPE_INT, p_res, 0);
+}
+
+// (ends_with str suffix)
+// returns 1 if str ends with suffix, else returns 0
+Generic *StdLib_ends_with(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_STRING};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "ends_with");
+  validateType(allowedTypes, 1, args[1]->type, 2, lineNumber, "ends_with");
+
+  char *str = *((char **) args[0]->p_val);
+  char *suffix = *((char **) args[1]->p_val);
+  size_t strLength = strlen(str);
+  size_t suffixLength = strlen(suffix);
+
+  int *p_res = (int *) malloc(sizeof(int));
+  *p_res = suffixLength <= strLength && memcmp(str + strLength - suffixLength, suffix, suffixLength) == 0;
+  return Generic_new(TYPE_INT, p_res, 0);
+}
+
+// (repeat str n)
+// returns str repeated n times
+Generic *StdLib_repeat(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes1[] = {TYPE_STRING};
+  validateType(allowedTypes1, 1, args[0]->type, 1, lineNumber, "repeat");
+
+  enum Type allowedTypes2[] = {TYPE_INT};
+  validateType(allowedTypes2, 1, args[1]->type, 2, lineNumber, "repeat");
+  validateMin(args[1]->p_val, 0, 2, lineNumber, "repeat");
+
+  char *str = *((char **) args[0]->p_val);
+  size_t strLength = strlen(str);
+  size_t resLength = strLength * *((int *) args[1]->p_val);
+
+  char *res = (char *) malloc(sizeof(char) * (resLength + 1));
+
+  // copy str once, then keep doubling what has been written
+  if (resLength > 0) {
+    memcpy(res, str, strLength);
+    size_t written = strLength;
+
+    while (written < resLength) {
+      size_t chunk = written < resLength - written ? written : resLength - written;
+      memcpy(res + written, res, chunk);
+      written += chunk;
+    }
+  }
+
+  res[resLength] = '\0';
+
+  char **p_res = (char **) malloc(sizeof(char *));
+  *p_res = res;
+
+  return Generic_new(TYPE_STRING, p_res, 0);
+}
+
+/* sequences */
+// (seq n) or (seq list)
+// returns a sequence of the integers from 0 to n - 1, or of the items in list
+Generic *StdLib_seq(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_INT, TYPE_LIST};
+  validateType(allowedTypes, 2, args[0]->type, 1, lineNumber, "seq");
+
+  if (args[0]->type == TYPE_LIST) {
+    return Generic_new(TYPE_SEQUENCE, Sequence_fromList((List *) args[0]->p_val), 0);
+  }
+
+  validateMin(args[0]->p_val, 0, 1, lineNumber, "seq");
+  return Generic_new(TYPE_SEQUENCE, Sequence_range(*((int *) args[0]->p_val)), 0);
+}
+
+// (filter list fn)
+// returns the items in list for which fn returns 1
+// if list is a sequence, returns a sequence which applys fn as items are consumed
+Generic *StdLib_filter(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes1[] = {TYPE_LIST, TYPE_SEQUENCE};
+  validateType(allowedTypes1, 2, args[0]->type, 1, lineNumber, "filter");
+
+  enum Type allowedTypes2[] = {TYPE_FUNCTION, TYPE_NATIVEFUNCTION};
+  validateType(allowedTypes2, 2, args[1]->type, 2, lineNumber, "filter");
+
+  if (args[0]->type == TYPE_SEQUENCE) {
+    return Generic_new(TYPE_SEQUENCE, Sequence_filter((Sequence *) args[0]->p_val, args[1]), 0);
+  }
+
+  List *p_list = (List *) (args[0]->p_val);
+  Generic **vals = (Generic **) malloc(sizeof(Generic *) * (p_list->len + 1));
+  int count = 0;
+
+  for (int i = 0; i < p_list->len; i++) {
+    int *p_i = (int *) malloc(sizeof(int));
+    *p_i = i;
+
+    Generic *newArgs[] = {List_get(p_list, i), Generic_new(TYPE_INT, p_i, 0)};
+    Generic *p_keep = applyFunc(args[1], p_scope, newArgs, 2, lineNumber);
+
+    if (p_keep->type != TYPE_INT || (*((int *) p_keep->p_val) != 0 && *((int *) p_keep->p_val) != 1)) {
+      printf("Runtime Error @ Line %i: filter function expected fn to return 0 or 1.\n", lineNumber);
+      exit(0);
+    }
+
+    if (*((int *) p_keep->p_val)) vals[count++] = List_get(p_list, i);
+    if (p_keep->refCount == 0) Generic_free(p_keep);
+  }
+
+  return Generic_new(TYPE_LIST, List_wrap(vals, count), 0);
+}
+
+// (take list n)
+// returns the first n items of list (or all of list, if it is shorter)
+// if list is a sequence, returns a sequence, which stops consuming list after n items
+Generic *StdLib_take(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes1[] = {TYPE_LIST, TYPE_SEQUENCE};
+  validateType(allowedTypes1, 2, args[0]->type, 1, lineNumber, "take");
+
+  enum Type allowedTypes2[] = {TYPE_INT};
+  validateType(allowedTypes2, 1, args[1]->type, 2, lineNumber, "take");
+  validateMin(args[1]->p_val, 0, 2, lineNumber, "take");
+
+  int count = *((int *) args[1]->p_val);
+
+  if (args[0]->type == TYPE_SEQUENCE) {
+    return Generic_new(TYPE_SEQUENCE, Sequence_take((Sequence *) args[0]->p_val, count), 0);
+  }
+
+  List *p_list = (List *) (args[0]->p_val);
+  return Generic_new(TYPE_LIST, List_sublist(p_list, 0, count < p_list->len ? count : p_list->len), 0);
+}
+
+// (collect seq)
+// consumes seq, returning a list of its items
+Generic *StdLib_collect(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_SEQUENCE, TYPE_LIST};
+  validateType(allowedTypes, 2, args[0]->type, 1, lineNumber, "collect");
+
+  if (args[0]->type == TYPE_LIST) return Generic_copy(args[0]);
+  return Generic_new(TYPE_LIST, Sequence_collect((Sequence *) args[0]->p_val, p_scope, lineNumber), 0);
+}
+
+// (generator fn arg1 arg2 ...)
+// returns a sequence of the values that (fn arg1 arg2 ...) passes to yield
+// fn runs as the sequence is consumed, pausing at every yield until the next item is needed
+Generic *StdLib_generator(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateMinArgCount(1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_FUNCTION, TYPE_NATIVEFUNCTION};
+  validateType(allowedTypes, 2, args[0]->type, 1, lineNumber, "generator");
+
+  // List_new copies the arguments
+  List *p_args = List_new(&args[1], length - 1);
+  return Generic_new(TYPE_SEQUENCE, Sequence_generator(args[0], p_args), 0);
+}
+
+// (yield value)
+// passes a copy of value to the consumer of the current generator, and waits until the next item is needed
+Generic *StdLib_yield(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  if (Coroutine_current() == NULL) {
+    printf("Runtime Error @ Line %i: yield function can only be called by a generator.\n", lineNumber);
+    exit(0);
   }
+
+  Coroutine_yield(Generic_copy(args[0]));
+  return Generic_new(TYPE_VOID, NULL, 0);
+}
+
+/* fusion */
+// used by eval, for applications flagged by the fusion pass (see fuse.c)
+
+// returns true if func is a builtin which accepts a sequence in place of a list as its first argument
+bool isFusedConsumer(Generic *func) {
+  if (func->type != TYPE_NATIVEFUNCTION) return false;
+
+  return (
+    func->p_val == &StdLib_reduce || func->p_val == &StdLib_length
+    || func->p_val == &StdLib_map || func->p_val == &StdLib_filter
+  );
+}
+
+// returns true if func is a builtin which can return a sequence in place of a list
+bool isFusedProducer(Generic *func) {
+  if (func->type != TYPE_NATIVEFUNCTION) return false;
+  return func->p_val == &StdLib_range || func->p_val == &StdLib_map || func->p_val == &StdLib_filter;
+}
+
+// applys a producer, returning a sequence of the items it would have returned as a list
+Generic *applyFusedProducer(Generic *func, Generic *args[], int length, int lineNumber) {
+  if (func->p_val == &StdLib_range) {
+    validateArgCount(1, 1, length, lineNumber);
+
+    enum Type allowedTypes[] = {TYPE_INT};
+    validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "range");
+    validateMin(args[0]->p_val, 0, 1, lineNumber, "range");
+
+    return Generic_new(TYPE_SEQUENCE, Sequence_range(*((int *) args[0]->p_val)), 0);
+  }
+
+  char *funcName = func->p_val == &StdLib_map ? "map" : "filter";
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes1[] = {TYPE_LIST, TYPE_SEQUENCE};
+  validateType(allowedTypes1, 2, args[0]->type, 1, lineNumber, funcName);
+
+  enum Type allowedTypes2[] = {TYPE_FUNCTION, TYPE_NATIVEFUNCTION};
+  validateType(allowedTypes2, 2, args[1]->type, 2, lineNumber, funcName);
+
+  Sequence *p_source = args[0]->type == TYPE_LIST 
+    ? Sequence_fromList((List *) args[0]->p_val) 
+    : Sequence_copy((Sequence *) args[0]->p_val);
+
+  Sequence *p_res = func->p_val == &StdLib_map 
+    ? Sequence_map(p_source, args[1]) 
+    : Sequence_filter(p_source, args[1]);
+
+  Sequence_free(p_source);
+  return Generic_new(TYPE_SEQUENCE, p_res, 0);
+}
+
+/* folding */
+// used by the folding pass (see fold.c), to evaluate applications of pure builtins to constants before running
+// every builtin has a check, which returns true only if the builtin can not throw an error for the supplied arguments
+// errors are left to happen at runtime, if the application is ever evaluated
+
+// returns true if every argument is an integer or float
+bool allNumbers(Generic *args[], int length) {
+  for (int i = 0; i < length; i++) {
+    if (args[i]->type != TYPE_INT && args[i]->type != TYPE_FLOAT) return false;
+  }
+
+  return true;
+}
+
+// returns true if val is 0 or 0.0
+bool isZero(Generic *val) {
+  return val->type == TYPE_FLOAT ? *((double *) val->p_val) == 0 : *((int *) val->p_val) == 0;
+}
+
+// add, subtract and multiply
+bool canFoldArithmetic(Generic *args[], int length) {
+  return length >= 2 && allNumbers(args, length);
+}
+
+// divide, which throws an error when dividing by 0
+bool canFoldDivide(Generic *args[], int length) {
+  if (!canFoldArithmetic(args, length)) return false;
+
+  for (int i = 1; i < length; i++) {
+    if (isZero(args[i])) return false;
+  }
+
+  return true;
+}
+
+// remainder
+bool canFoldRemainder(Generic *args[], int length) {
+  return length == 2 && allNumbers(args, length) && !isZero(args[1]);
+}
+
+// power, less_than and greater_than
+bool canFoldBinaryNumbers(Generic *args[], int length) {
+  return length == 2 && allNumbers(args, length);
+}
+
+// is
+bool canFoldIs(Generic *args[], int length) {
+  return length == 2;
+}
+
+// returns true if every argument is 0 or 1
+bool allBinary(Generic *args[], int length) {
+  for (int i = 0; i < length; i++) {
+    if (args[i]->type != TYPE_INT || (*((int *) args[i]->p_val) != 0 && *((int *) args[i]->p_val) != 1)) return false;
+  }
+
+  return true;
+}
+
+// not
+bool canFoldNot(Generic *args[], int length) {
+  return length == 1 && allBinary(args, length);
+}
+
+// and, or
+bool canFoldAndOr(Generic *args[], int length) {
+  return length >= 2 && allBinary(args, length);
+}
+
+// list
+bool canFoldList(Generic *args[], int length) {
+  return true;
+}
+
+// join, which takes all strings or all lists
+bool canFoldJoin(Generic *args[], int length) {
+  if (length < 2 || (args[0]->type != TYPE_STRING && args[0]->type != TYPE_LIST)) return false;
+
+  for (int i = 1; i < length; i++) {
+    if (args[i]->type != args[0]->type) return false;
+  }
+
+  return true;
+}
+
+// string
+bool canFoldString(Generic *args[], int length) {
+  return length == 1 && (args[0]->type == TYPE_STRING || allNumbers(args, length));
+}
+
+// length
+bool canFoldLength(Generic *args[], int length) {
+  return length == 1 && (args[0]->type == TYPE_STRING || args[0]->type == TYPE_LIST);
+}
+
+// a builtin without side effects, which the folding pass can evaluate
+typedef struct PureBuiltin {
+  char *name;
+  Generic *(*func)(Scope *, Generic *[], int, int);
+  bool (*canFold)(Generic *[], int);
+} PureBuiltin;
+
+PureBuiltin pureBuiltins[] = {
+  {"add", &StdLib_add, &canFoldArithmetic},
+  {"subtract", &StdLib_subtract, &canFoldArithmetic},
+  {"multiply", &StdLib_multiply, &canFoldArithmetic},
+  {"divide", &StdLib_divide, &canFoldDivide},
+  {"remainder", &StdLib_remainder, &canFoldRemainder},
+  {"power", &StdLib_power, &canFoldBinaryNumbers},
+  {"is", &StdLib_is, &canFoldIs},
+  {"less_than", &StdLib_less_than, &canFoldBinaryNumbers},
+  {"greater_than", &StdLib_greater_than, &canFoldBinaryNumbers},
+  {"not", &StdLib_not, &canFoldNot},
+  {"and", &StdLib_and, &canFoldAndOr},
+  {"or", &StdLib_or, &canFoldAndOr},
+  {"list", &StdLib_list, &canFoldList},
+  {"join", &StdLib_join, &canFoldJoin},
+  {"string", &StdLib_string, &canFoldString},
+  {"length", &StdLib_length, &canFoldLength}
+};
+
+// returns the pure builtin which name is bound to in the global scope, or NULL if there is none
+PureBuiltin *findPureBuiltin(char *name) {
+  for (size_t i = 0; i < sizeof(pureBuiltins) / sizeof(PureBuiltin); i++) {
+    if (strcmp(pureBuiltins[i].name, name) == 0) return &pureBuiltins[i];
+  }
+
+  return NULL;
+}
+
+// returns true if name is bound to a pure builtin in the global scope
+bool isPureBuiltinName(char *name) {
+  return findPureBuiltin(name) != NULL;
+}
+
+// returns true if func is the pure builtin which name is bound to in the global scope
+bool isPureBuiltin(char *name, Generic *func) {
+  PureBuiltin *p_builtin = findPureBuiltin(name);
+  return p_builtin != NULL && func->type == TYPE_NATIVEFUNCTION && func->p_val == p_builtin->func;
+}
+
+// applies the pure builtin which name is bound to in the global scope
+// returns NULL if there is no such builtin, or if it would throw an error for args
+Generic *foldPureBuiltin(char *name, Generic *args[], int length) {
+  PureBuiltin *p_builtin = findPureBuiltin(name);
+  if (p_builtin == NULL || !p_builtin->canFold(args, length)) return NULL;
+
+  return p_builtin->func(NULL, args, length, 0);
+}
+
+/* vectors */
+// (sum list)
+// returns the sum of all items in list
+Generic *StdLib_sum(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_LIST};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "sum");
+
+  List *p_list = getNumericList(args[0], 1, lineNumber, "sum");
+  Generic *res;
+
+  if (p_list->storage == LIST_INT) {
+    int *p_res = (int *) malloc(sizeof(int));
+    *p_res = Vector_sumInts(p_list->ints, p_list->len);
+    res = Generic_new(TYPE_INT, p_res, 0);
+  } else {
+    double *p_res = (double *) malloc(sizeof(double));
+    *p_res = Vector_sumFloats(p_list->floats, p_list->len);
+    res = Generic_new(TYPE_FLOAT, p_res, 0);
+  }
+
+  releaseNumericList(p_list, args[0]);
+  return res;
+}
+
+// (product list)
+// returns the product of all items in list
+Generic *StdLib_product(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_LIST};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "product");
+
+  List *p_list = getNumericList(args[0], 1, lineNumber, "product");
+  Generic *res;
+
+  if (p_list->storage == LIST_INT) {
+    int *p_res = (int *) malloc(sizeof(int));
+    *p_res = Vector_productInts(p_list->ints, p_list->len);
+    res = Generic_new(TYPE_INT, p_res, 0);
+  } else {
+    double *p_res = (double *) malloc(sizeof(double));
+    *p_res = Vector_productFloats(p_list->floats, p_list->len);
+    res = Generic_new(TYPE_FLOAT, p_res, 0);
+  }
+
+  releaseNumericList(p_list, args[0]);
+  return res;
+}
+
+// (dot a b)
+// returns the dot product of lists a and b
+Generic *StdLib_dot(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_LIST};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "dot");
+  validateType(allowedTypes, 1, args[1]->type, 2, lineNumber, "dot");
+
+  List *p_a = getNumericList(args[0], 1, lineNumber, "dot");
+  List *p_b = getNumericList(args[1], 2, lineNumber, "dot");
+  validateSameLength(p_a, p_b, lineNumber, "dot");
+
+  // integers are only kept if both lists are integers
+  if (p_a->storage != p_b->storage) {
+    p_a = promoteNumericList(p_a, args[0]);
+    p_b = promoteNumericList(p_b, args[1]);
+  }
+
+  Generic *res;
+
+  if (p_a->storage == LIST_INT) {
+    int *p_res = (int *) malloc(sizeof(int));
+    *p_res = Vector_dotInts(p_a->ints, p_b->ints, p_a->len);
+    res = Generic_new(TYPE_INT, p_res, 0);
+  } else {
+    double *p_res = (double *) malloc(sizeof(double));
+    *p_res = Vector_dotFloats(p_a->floats, p_b->floats, p_a->len);
+    res = Generic_new(TYPE_FLOAT, p_res, 0);
+  }
+
+  releaseNumericList(p_a, args[0]);
+  releaseNumericList(p_b, args[1]);
+  return res;
+}
+
+// (min list) or (max list)
+// returns the smallest or largest item in list, as it appears in list
+Generic *findExtreme(Generic *args[], int length, int lineNumber, char *funcName, bool max) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_LIST};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, funcName);
+
+  List *p_list = getNumericList(args[0], 1, lineNumber, funcName);
+  validateNonEmpty(p_list, 1, lineNumber, funcName);
+
+  Generic *res;
+
+  if (p_list->storage == LIST_INT) {
+    int *p_res = (int *) malloc(sizeof(int));
+    *p_res = max ? Vector_maxInts(p_list->ints, p_list->len) : Vector_minInts(p_list->ints, p_list->len);
+    res = Generic_new(TYPE_INT, p_res, 0);
+  } else {
+    double *p_res = (double *) malloc(sizeof(double));
+    *p_res = max ? Vector_maxFloats(p_list->floats, p_list->len) : Vector_minFloats(p_list->floats, p_list->len);
+    res = Generic_new(TYPE_FLOAT, p_res, 0);
+  }
+
+  // if the list mixed integers and floats, return the original item, so integers stay integers
+  if (p_list != args[0]->p_val) {
+    List *p_original = (List *) args[0]->p_val;
+    Generic *p_item = List_get(p_original, List_find(p_original, res));
+
+    Generic_free(res);
+    res = p_item;
+  }
+
+  releaseNumericList(p_list, args[0]);
+  return res;
+}
+
+Generic *StdLib_min(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  return findExtreme(args, length, lineNumber, "min", false);
+}
+
+Generic *StdLib_max(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  return findExtreme(args, length, lineNumber, "max", true);
+}
+
+// (vadd a b) or (vmul a b)
+// returns a list with the sums or products of the items in a and b, pairwise
+Generic *applyElementwise(Generic *args[], int length, int lineNumber, char *funcName, bool multiply) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_LIST};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, funcName);
+  validateType(allowedTypes, 1, args[1]->type, 2, lineNumber, funcName);
+
+  List *p_a = getNumericList(args[0], 1, lineNumber, funcName);
+  List *p_b = getNumericList(args[1], 2, lineNumber, funcName);
+  validateSameLength(p_a, p_b, lineNumber, funcName);
+
+  // integers are only kept if both lists are integers
+  if (p_a->storage != p_b->storage) {
+    p_a = promoteNumericList(p_a, args[0]);
+    p_b = promoteNumericList(p_b, args[1]);
+  }
+
+  List *p_res = List_alloc(p_a->storage, p_a->len);
+
+  if (p_a->storage == LIST_INT) {
+    if (multiply) Vector_mulInts(p_res->ints, p_a->ints, p_b->ints, p_a->len);
+    else Vector_addInts(p_res->ints, p_a->ints, p_b->ints, p_a->len);
+  } else {
+    if (multiply) Vector_mulFloats(p_res->floats, p_a->floats, p_b->floats, p_a->len);
+    else Vector_addFloats(p_res->floats, p_a->floats, p_b->floats, p_a->len);
+  }
+
+  releaseNumericList(p_a, args[0]);
+  releaseNumericList(p_b, args[1]);
+  return Generic_new(TYPE_LIST, p_res, 0);
+}
+
+Generic *StdLib_vadd(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  return applyElementwise(args, length, lineNumber, "vadd", false);
+}
+
+Generic *StdLib_vmul(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  return applyElementwise(args, length, lineNumber, "vmul", true);
+}
+
+// (vscale list k)
+// returns a list with every item in list multiplied by k
+Generic *StdLib_vscale(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes1[] = {TYPE_LIST};
+  validateType(allowedTypes1, 1, args[0]->type, 1, lineNumber, "vscale");
+
+  enum Type allowedTypes2[] = {TYPE_INT, TYPE_FLOAT};
+  validateType(allowedTypes2, 2, args[1]->type, 2, lineNumber, "vscale");
+
+  List *p_list = getNumericList(args[0], 1, lineNumber, "vscale");
+
+  // integers are only kept if both the list and k are integers
+  if (args[1]->type == TYPE_FLOAT) p_list = promoteNumericList(p_list, args[0]);
+
+  List *p_res = List_alloc(p_list->storage, p_list->len);
+
+  if (p_list->storage == LIST_INT) {
+    Vector_scaleInts(p_res->ints, p_list->ints, *((int *) args[1]->p_val), p_list->len);
+  } else {
+    double k = args[1]->type == TYPE_FLOAT ? *((double *) args[1]->p_val) : *((int *) args[1]->p_val);
+    Vector_scaleFloats(p_res->floats, p_list->floats, k, p_list->len);
+  }
+
+  releaseNumericList(p_list, args[0]);
+  return Generic_new(TYPE_LIST, p_res, 0);
+}
+
+// (cumsum list)
+// returns a list with the running total of list
+Generic *StdLib_cumsum(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_LIST};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "cumsum");
+
+  List *p_list = getNumericList(args[0], 1, lineNumber, "cumsum");
+  List *p_res = List_alloc(p_list->storage, p_list->len);
+
+  if (p_list->storage == LIST_INT) Vector_cumsumInts(p_res->ints, p_list->ints, p_list->len);
+  else Vector_cumsumFloats(p_res->floats, p_list->floats, p_list->len);
+
+  releaseNumericList(p_list, args[0]);
+  return Generic_new(TYPE_LIST, p_res, 0);
+}
+
+/* maps */
+// (map_new key1 value1 key2 value2 ...)
+// returns a new map, with each key set to the value after it
+Generic *StdLib_map_new(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  if (length % 2 != 0) {
+    printf("Runtime Error @ Line %i: map_new function requires a value for every key.\n", lineNumber);
+    exit(0);
+  }
+
+  Map *p_res = Map_new();
+
+  for (int i = 0; i < length; i += 2) {
+    Map *p_next = Map_set(p_res, args[i], args[i + 1]);
+    Map_free(p_res);
+    p_res = p_next;
+  }
+
+  return Generic_new(TYPE_MAP, p_res, 0);
+}
+
+// (map_get map key)
+// returns the value at key in map, or void if key is not in map
+Generic *StdLib_map_get(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_MAP};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "map_get");
+
+  Generic *p_res = Map_get((Map *) args[0]->p_val, args[1]);
+  if (p_res == NULL) return Generic_new(TYPE_VOID, NULL, 0);
+
+  // the value belongs to the map, so return a copy
+  return Generic_copy(p_res);
+}
+
+// (map_set map key value)
+// returns a new map, with key set to value
+Generic *StdLib_map_set(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(3, 3, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_MAP};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "map_set");
+
+  return Generic_new(TYPE_MAP, Map_set((Map *) args[0]->p_val, args[1], args[2]), 0);
+}
+
+// (map_has map key)
+// returns 1 if key is in map, else returns 0
+Generic *StdLib_map_has(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_MAP};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "map_has");
+
+  int *p_res = (int *) malloc(sizeof(int));
+  *p_res = Map_get((Map *) args[0]->p_val, args[1]) != NULL;
+  return Generic_new(TYPE_INT, p_res, 0);
+}
+
+// (map_delete map key)
+// returns a new map, without key
+Generic *StdLib_map_delete(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_MAP};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "map_delete");
+
+  return Generic_new(TYPE_MAP, Map_delete((Map *) args[0]->p_val, args[1]), 0);
+}
+
+// (map_keys map)
+// returns a list of the keys in map, in no particular order
+Generic *StdLib_map_keys(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_MAP};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "map_keys");
+
+  return Generic_new(TYPE_LIST, Map_keys((Map *) args[0]->p_val), 0);
+}
+
+/* sorting */
+// (sort list)
+// returns a new list with the items of list in ascending order
+Generic *StdLib_sort(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_LIST};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "sort");
+
+  return Generic_new(TYPE_LIST, sortList((List *) args[0]->p_val, false, lineNumber, "sort"), 0);
+}
+
+// (sort_desc list)
+// returns a new list with the items of list in descending order
+Generic *StdLib_sort_desc(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_LIST};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "sort_desc");
+
+  return Generic_new(TYPE_LIST, sortList((List *) args[0]->p_val, true, lineNumber, "sort_desc"), 0);
+}
+
+// (sort_by list fn)
+// returns a new list with the items of list in ascending order of (fn item i)
+// fn is applied once per item, and items with equal keys keep their order
+Generic *StdLib_sort_by(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes1[] = {TYPE_LIST};
+  validateType(allowedTypes1, 1, args[0]->type, 1, lineNumber, "sort_by");
+
+  enum Type allowedTypes2[] = {TYPE_FUNCTION, TYPE_NATIVEFUNCTION};
+  validateType(allowedTypes2, 2, args[1]->type, 2, lineNumber, "sort_by");
+
+  List *p_list = (List *) (args[0]->p_val);
+
+  SortKey *keys = (SortKey *) malloc(sizeof(SortKey) * (p_list->len + 1));
+  Generic **keyVals = (Generic **) malloc(sizeof(Generic *) * (p_list->len + 1));
+  bool strings = false;
+
+  for (int i = 0; i < p_list->len; i++) {
+    int *p_i = (int *) malloc(sizeof(int));
+    *p_i = i;
+
+    // keep each key alive until sorted, as string keys point into it
+    Generic *newArgs[] = {List_get(p_list, i), Generic_new(TYPE_INT, p_i, 0)};
+    keyVals[i] = applyFunc(args[1], p_scope, newArgs, 2, lineNumber);
+    getSortKey(keyVals[i], &keys[i], i, &strings, lineNumber, "sort_by");
+  }
+
+  Sort_keysStable(keys, p_list->len, false);
+  List *p_res = permuteList(p_list, keys);
+
+  for (int i = 0; i < p_list->len; i++) {
+    if (keyVals[i]->refCount == 0) Generic_free(keyVals[i]);
+  }
+
+  free(keyVals);
+  free(keys);
+  return Generic_new(TYPE_LIST, p_res, 0);
+}
+
+/* parallel */
+// number of chunks given to each worker, more chunks balance better when items take uneven time
+#define PARALLEL_CHUNKS_PER_WORKER 8
+
+// state shared by the workers of pmap and preduce
+// every worker gets its own isolated scope and copy of fn, so workers never share a reference count
+typedef struct ParallelJob {
+  List *p_list;
+  Scope **scopes;
+  Generic **funcs;
+  Generic **results;
+  int lineNumber;
+} ParallelJob;
+
+// creates the scopes and function copies for every worker (on the calling thread)
+ParallelJob *ParallelJob_new(List *p_list, Generic *p_func, Scope *p_scope, int resultCount, int lineNumber) {
+  ParallelJob *res = (ParallelJob *) malloc(sizeof(ParallelJob));
+  int workers = Pool_size();
+
+  res->p_list = p_list;
+  res->scopes = (Scope **) malloc(sizeof(Scope *) * workers);
+  res->funcs = (Generic **) malloc(sizeof(Generic *) * workers);
+  res->results = (Generic **) malloc(sizeof(Generic *) * resultCount);
+  res->lineNumber = lineNumber;
+
+  for (int i = 0; i < workers; i++) {
+    res->scopes[i] = Scope_newIsolated(p_scope);
+
+    // hold a reference, so that applyFunc does not free the copy
+    res->funcs[i] = Generic_copy(p_func);
+    res->funcs[i]->refCount++;
+  }
+
+  return res;
+}
+
+// frees the scopes and function copies of every worker, results are left to the caller
+void ParallelJob_free(ParallelJob *p_job) {
+  for (int i = 0; i < Pool_size(); i++) {
+    Scope_free(p_job->scopes[i]);
+    Generic_free(p_job->funcs[i]);
+  }
+
+  free(p_job->scopes);
+  free(p_job->funcs);
+  free(p_job);
+}
+
+// applies fn to every item in a chunk, see StdLib_pmap
+void pmapTask(void *p_data, int chunk, int start, int end, int worker) {
+  ParallelJob *p_job = (ParallelJob *) p_data;
+
+  for (int i = start; i < end; i++) {
+    int *p_i = (int *) malloc(sizeof(int));
+    *p_i = i;
+
+    Generic *newArgs[] = {List_get(p_job->p_list, i), Generic_new(TYPE_INT, p_i, 0)};
+    p_job->results[i] = applyFunc(p_job->funcs[worker], p_job->scopes[worker], newArgs, 2, p_job->lineNumber);
+  }
+}
+
+// reduces a chunk to a single value, see StdLib_preduce
+void preduceTask(void *p_data, int chunk, int start, int end, int worker) {
+  ParallelJob *p_job = (ParallelJob *) p_data;
+  Generic *p_acc = List_get(p_job->p_list, start);
+
+  for (int i = start + 1; i < end; i++) {
+    Generic *newArgs[] = {p_acc, List_get(p_job->p_list, i)};
+    p_acc = applyFunc(p_job->funcs[worker], p_job->scopes[worker], newArgs, 2, p_job->lineNumber);
+  }
+
+  p_job->results[chunk] = p_acc;
+}
+
+// (pmap list fn)
+// applys fn to every item in list on all cpus, returns list with results
+// fn is called with an item and its index, in no particular order
+Generic *StdLib_pmap(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes1[] = {TYPE_LIST};
+  validateType(allowedTypes1, 1, args[0]->type, 1, lineNumber, "pmap");
+
+  enum Type allowedTypes2[] = {TYPE_FUNCTION, TYPE_NATIVEFUNCTION};
+  validateType(allowedTypes2, 2, args[1]->type, 2, lineNumber, "pmap");
+
+  List *p_list = (List *) args[0]->p_val;
+  ParallelJob *p_job = ParallelJob_new(p_list, args[1], p_scope, p_list->len, lineNumber);
+
+  Pool_run(&pmapTask, p_job, p_list->len, Pool_size() * PARALLEL_CHUNKS_PER_WORKER);
+
+  // results are collected boxed, and packed by List_wrap if possible
+  Generic *res = Generic_new(TYPE_LIST, List_wrap(p_job->results, p_list->len), 0);
+  ParallelJob_free(p_job);
+
+  return res;
+}
+
+// (preduce list fn initial)
+// reduces list with fn on all cpus, fn takes 2 values, and must be associative
+// chunks of the list are reduced in parallel, and the results combined in order, starting from initial (if supplied)
+Generic *StdLib_preduce(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 3, length, lineNumber);
+
+  enum Type allowedTypes1[] = {TYPE_LIST};
+  validateType(allowedTypes1, 1, args[0]->type, 1, lineNumber, "preduce");
+
+  enum Type allowedTypes2[] = {TYPE_FUNCTION, TYPE_NATIVEFUNCTION};
+  validateType(allowedTypes2, 2, args[1]->type, 2, lineNumber, "preduce");
+
+  List *p_list = (List *) args[0]->p_val;
+
+  if (p_list->len == 0) {
+    if (length == 3) return Generic_copy(args[2]);
+
+    printf("Runtime Error @ Line %i: preduce function requires an initial value for an empty list.\n", lineNumber);
+    exit(0);
+  }
+
+  // Pool_run never makes more chunks than items
+  int chunkCount = Pool_size() * PARALLEL_CHUNKS_PER_WORKER;
+  if (chunkCount > p_list->len) chunkCount = p_list->len;
+
+  ParallelJob *p_job = ParallelJob_new(p_list, args[1], p_scope, chunkCount, lineNumber);
+  Pool_run(&preduceTask, p_job, p_list->len, chunkCount);
+
+  // combine the result of every chunk, in order
+  Generic *p_acc = length == 3 ? Generic_copy(args[2]) : p_job->results[0];
+
+  for (int i = length == 3 ? 0 : 1; i < chunkCount; i++) {
+    Generic *newArgs[] = {p_acc, p_job->results[i]};
+    p_acc = applyFunc(args[1], p_scope, newArgs, 2, lineNumber);
+  }
+
+  free(p_job->results);
+  ParallelJob_free(p_job);
+
+  return p_acc;
+}
+
+/* channels */
+// capacity of channels made by (channel)
+#define CHANNEL_DEFAULT_CAPACITY 64
+
+// stack size for threads started by spawn, as eval recurses deeply
+#define SPAWN_STACK_SIZE (64 * 1024 * 1024)
+
+// a function started by spawn, with the scope and arguments its thread owns
+typedef struct SpawnTask {
+  Generic *p_func;
+  Generic **args;
+  int length;
+  Scope *p_scope;
+  int lineNumber;
+} SpawnTask;
+
+// runs a spawned function on its own thread, and frees everything it owned
+void *runSpawned(void *p_data) {
+  SpawnTask *p_task = (SpawnTask *) p_data;
+
+  // applyFunc frees the function and arguments, as they are unreferenced
+  Generic *res = applyFunc(p_task->p_func, p_task->p_scope, p_task->args, p_task->length, p_task->lineNumber);
+  if (res->refCount == 0) Generic_free(res);
+
+  Scope_free(p_task->p_scope);
+  free(p_task->args);
+  free(p_task);
+
+  return NULL;
+}
+
+// (spawn fn arg1 arg2 ...)
+// runs fn with the supplied arguments on a new thread, and returns void without waiting for it
+// fn runs in a copy of the current scope, so variables changed on either thread are not seen by the other
+Generic *StdLib_spawn(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateMinArgCount(1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_FUNCTION, TYPE_NATIVEFUNCTION};
+  validateType(allowedTypes, 2, args[0]->type, 1, lineNumber, "spawn");
+
+  // everything the new thread uses is copied here, so that it shares no generics with this thread
+  SpawnTask *p_task = (SpawnTask *) malloc(sizeof(SpawnTask));
+  p_task->p_func = Generic_copy(args[0]);
+  p_task->length = length - 1;
+  p_task->args = (Generic **) malloc(sizeof(Generic *) * (length - 1));
+  p_task->p_scope = Scope_snapshot(p_scope);
+  p_task->lineNumber = lineNumber;
+
+  for (int i = 1; i < length; i++) {
+    p_task->args[i - 1] = Generic_copy(args[i]);
+  }
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, SPAWN_STACK_SIZE);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+  pthread_t thread;
+  if (pthread_create(&thread, &attr, runSpawned, p_task) != 0) {
+    printf("Runtime Error @ Line %i: spawn function could not start a new thread.\n", lineNumber);
+    exit(0);
+  }
+
+  pthread_attr_destroy(&attr);
+  return Generic_new(TYPE_VOID, NULL, 0);
+}
+
+// (channel capacity)
+// returns a new channel, which holds up to capacity values (64 if not supplied)
+Generic *StdLib_channel(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(0, 1, length, lineNumber);
+
+  int capacity = CHANNEL_DEFAULT_CAPACITY;
+  if (length == 1) {
+    enum Type allowedTypes[] = {TYPE_INT};
+    validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "channel");
+    validateMin(args[0]->p_val, 1, 1, lineNumber, "channel");
+    capacity = *((int *) args[0]->p_val);
+  }
+
+  return Generic_new(TYPE_CHANNEL, Channel_new(capacity), 0);
+}
+
+// (send channel value)
+// sends a copy of value into channel, waiting while channel is full
+Generic *StdLib_send(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(2, 2, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_CHANNEL};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "send");
+
+  Channel_send((Channel *) args[0]->p_val, Generic_copy(args[1]));
+  return Generic_new(TYPE_VOID, NULL, 0);
+}
+
+// (receive channel)
+// returns the oldest value sent into channel, waiting while channel is empty
+Generic *StdLib_receive(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_CHANNEL};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "receive");
+
+  return Channel_receive((Channel *) args[0]->p_val);
+}
+
+/* memoization */
+// number of results cached by (memo fn)
+#define MEMO_DEFAULT_CAPACITY 4096
+
+// (memo fn capacity)
+// returns a memoized version of fn, which caches the results of up to capacity calls (4096 if not supplied)
+// once full, the result of the least recently used arguments is dropped
+Generic *StdLib_memo(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 2, length, lineNumber);
+
+  enum Type allowedTypes1[] = {TYPE_FUNCTION, TYPE_NATIVEFUNCTION};
+  validateType(allowedTypes1, 2, args[0]->type, 1, lineNumber, "memo");
+
+  int capacity = MEMO_DEFAULT_CAPACITY;
+  if (length == 2) {
+    enum Type allowedTypes2[] = {TYPE_INT};
+    validateType(allowedTypes2, 1, args[1]->type, 2, lineNumber, "memo");
+    validateMin(args[1]->p_val, 1, 2, lineNumber, "memo");
+    capacity = *((int *) args[1]->p_val);
+  }
+
+  return Generic_new(TYPE_MEMO, Memo_new(args[0], capacity), 0);
+}
+
+// adds an integer to a map under key, used by memo_stats
+Map *setStat(Map *p_stats, char *key, long val) {
+  Generic *p_key = newString(key, strlen(key));
+
+  int *p_val = (int *) malloc(sizeof(int));
+  *p_val = (int) val;
+  Generic *p_valGeneric = Generic_new(TYPE_INT, p_val, 0);
+
+  Map *res = Map_set(p_stats, p_key, p_valGeneric);
+  Map_free(p_stats);
+  Generic_free(p_key);
+  Generic_free(p_valGeneric);
+
+  return res;
+}
+
+// (memo_stats fn)
+// returns a map of the "hits", "misses", "size" and "capacity" of the cache of a memoized function
+Generic *StdLib_memo_stats(Scope *p_scope, Generic *args[], int length, int lineNumber) {
+  validateArgCount(1, 1, length, lineNumber);
+
+  enum Type allowedTypes[] = {TYPE_MEMO};
+  validateType(allowedTypes, 1, args[0]->type, 1, lineNumber, "memo_stats");
+
+  Memo *p_memo = (Memo *) args[0]->p_val;
+
+  pthread_mutex_lock(&p_memo->lock);
+  long hits = p_memo->hits;
+  long misses = p_memo->misses;
+  int size = p_memo->size;
+  pthread_mutex_unlock(&p_memo->lock);
+
+  Map *p_res = Map_new();
+  p_res = setStat(p_res, "hits", hits);
+  p_res = setStat(p_res, "misses", misses);
+  p_res = setStat(p_res, "size", size);
+  p_res = setStat(p_res, "capacity", p_memo->capacity);
+
+  return Generic_new(TYPE_MAP, p_res, 0);
+}
+
+// sets name (interned as a symbol) in the global scope to p_val
+void setGlobal(Scope *p_global, char *name, Generic *p_val) {
+  Scope_set(p_global, Symbol_intern(name, strlen(name)), p_val);
 }
 
 // creates a new global scope
 Scope *newGlobal(int argc, char *argv[]) {
 
   // initialize random number generator for (random)
-  srand(time(NULL) + clock());
+  randomSeed = ((unsigned long long) time(NULL) << 32) ^ clock();
 
   // create global scope
   Scope *p_global = Scope_new(NULL);
@@ -1592,7 +3447,7 @@ Scope *newGlobal(int argc, char *argv[]) {
   }
   
   // add arguments and arguments count
-  Scope_set(p_global, "arguments", Generic_new(TYPE_LIST, List_new(args, argc), 0));
+  setGlobal(p_global, "arguments", Generic_new(TYPE_LIST, List_new(args, argc), 0));
 
   // free arguments memory (as List_new does a copy)
   for (int i = 0; i < argc; i++) {
@@ -1601,63 +3456,126 @@ Scope *newGlobal(int argc, char *argv[]) {
   }
 
   // add void
-  Scope_set(p_global, "void", Generic_new(TYPE_VOID, NULL, 0));
+  setGlobal(p_global, "void", Generic_new(TYPE_VOID, NULL, 0));
 
   // populate global scope with stdlib functions
   /* IO */
-  Scope_set(p_global, "print", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_print, 0));
-  Scope_set(p_global, "input", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_input, 0));
-  Scope_set(p_global, "rows", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_rows, 0));
-  Scope_set(p_global, "columns", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_columns, 0));
-  Scope_set(p_global, "read_file", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_read_file, 0));
-  Scope_set(p_global, "write_file", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_write_file, 0));
-  Scope_set(p_global, "event", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_event, 0));
-  Scope_set(p_global, "use", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_use, 0));
-  Scope_set(p_global, "shell", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_shell, 0));
+  setGlobal(p_global, "print", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_print, 0));
+  setGlobal(p_global, "flush", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_flush, 0));
+  setGlobal(p_global, "input", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_input, 0));
+  setGlobal(p_global, "rows", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_rows, 0));
+  setGlobal(p_global, "columns", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_columns, 0));
+  setGlobal(p_global, "render", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_render, 0));
+  setGlobal(p_global, "read_file", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_read_file, 0));
+  setGlobal(p_global, "write_file", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_write_file, 0));
+  setGlobal(p_global, "event", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_event, 0));
+  setGlobal(p_global, "use", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_use, 0));
+  setGlobal(p_global, "shell", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_shell, 0));
 
   /* comparisions */
-  Scope_set(p_global, "is", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_is, 0));
-  Scope_set(p_global, "less_than", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_less_than, 0));
-  Scope_set(p_global, "greater_than", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_greater_than, 0));
+  setGlobal(p_global, "is", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_is, 0));
+  setGlobal(p_global, "less_than", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_less_than, 0));
+  setGlobal(p_global, "greater_than", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_greater_than, 0));
 
   /* logical operators */
-  Scope_set(p_global, "not", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_not, 0));
-  Scope_set(p_global, "and", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_and, 0));
-  Scope_set(p_global, "or", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_or, 0));
+  setGlobal(p_global, "not", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_not, 0));
+  setGlobal(p_global, "and", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_and, 0));
+  setGlobal(p_global, "or", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_or, 0));
 
   /* arithmetic */
-  Scope_set(p_global, "add", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_add, 0));
-  Scope_set(p_global, "subtract", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_subtract, 0));
-  Scope_set(p_global, "divide", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_divide, 0));
-  Scope_set(p_global, "multiply", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_multiply, 0));
-  Scope_set(p_global, "remainder", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_remainder, 0));
-  Scope_set(p_global, "power", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_power, 0));
-  Scope_set(p_global, "random", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_random, 0));
+  setGlobal(p_global, "add", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_add, 0));
+  setGlobal(p_global, "subtract", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_subtract, 0));
+  setGlobal(p_global, "divide", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_divide, 0));
+  setGlobal(p_global, "multiply", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_multiply, 0));
+  setGlobal(p_global, "remainder", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_remainder, 0));
+  setGlobal(p_global, "power", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_power, 0));
+  setGlobal(p_global, "random", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_random, 0));
   
   /* control */
-  Scope_set(p_global, "loop", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_loop, 0));
-  Scope_set(p_global, "until", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_until, 0));
-  Scope_set(p_global, "if", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_if, 0));
-  Scope_set(p_global, "wait", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_wait, 0));
+  setGlobal(p_global, "loop", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_loop, 0));
+  setGlobal(p_global, "until", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_until, 0));
+  setGlobal(p_global, "if", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_if, 0));
+  setGlobal(p_global, "wait", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_wait, 0));
+  setGlobal(p_global, "set_timeout", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_set_timeout, 0));
+  setGlobal(p_global, "set_interval", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_set_interval, 0));
+  setGlobal(p_global, "clear_timer", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_clear_timer, 0));
+  setGlobal(p_global, "run_timers", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_run_timers, 0));
 
   /* types */
-  Scope_set(p_global, "integer", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_integer, 0));
-  Scope_set(p_global, "string", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_string, 0));
-  Scope_set(p_global, "float", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_float, 0));
-  Scope_set(p_global, "type", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_type, 0));
+  setGlobal(p_global, "integer", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_integer, 0));
+  setGlobal(p_global, "string", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_string, 0));
+  setGlobal(p_global, "float", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_float, 0));
+  setGlobal(p_global, "type", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_type, 0));
 
   /* list and string */
-  Scope_set(p_global, "list", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_list, 0));
-  Scope_set(p_global, "length", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_length, 0));
-  Scope_set(p_global, "join", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_join, 0));
-  Scope_set(p_global, "get", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_get, 0));
-  Scope_set(p_global, "insert", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_insert, 0));
-  Scope_set(p_global, "set", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_set, 0));
-  Scope_set(p_global, "delete", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_delete, 0));
-  Scope_set(p_global, "map", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_map, 0));
-  Scope_set(p_global, "reduce", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_reduce, 0));
-  Scope_set(p_global, "range", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_range, 0));
-  Scope_set(p_global, "find", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_find, 0));
+  setGlobal(p_global, "list", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_list, 0));
+  setGlobal(p_global, "length", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_length, 0));
+  setGlobal(p_global, "join", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_join, 0));
+  setGlobal(p_global, "get", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_get, 0));
+  setGlobal(p_global, "insert", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_insert, 0));
+  setGlobal(p_global, "set", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_set, 0));
+  setGlobal(p_global, "delete", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_delete, 0));
+  setGlobal(p_global, "map", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_map, 0));
+  setGlobal(p_global, "reduce", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_reduce, 0));
+  setGlobal(p_global, "range", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_range, 0));
+  setGlobal(p_global, "find", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_find, 0));
+
+  /* sequences */
+  setGlobal(p_global, "seq", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_seq, 0));
+  setGlobal(p_global, "filter", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_filter, 0));
+  setGlobal(p_global, "take", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_take, 0));
+  setGlobal(p_global, "collect", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_collect, 0));
+  setGlobal(p_global, "generator", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_generator, 0));
+  setGlobal(p_global, "yield", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_yield, 0));
+
+  /* strings */
+  setGlobal(p_global, "split", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_split, 0));
+  setGlobal(p_global, "chars", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_chars, 0));
+  setGlobal(p_global, "replace", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_replace, 0));
+  setGlobal(p_global, "trim", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_trim, 0));
+  setGlobal(p_global, "upper", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_upper, 0));
+  setGlobal(p_global, "lower", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_lower, 0));
+  setGlobal(p_global, "starts_with", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_starts_with, 0));
+  setGlobal(p_global, "ends_with", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_ends_with, 0));
+  setGlobal(p_global, "repeat", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_repeat, 0));
+
+  /* vectors */
+  setGlobal(p_global, "sum", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_sum, 0));
+  setGlobal(p_global, "product", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_product, 0));
+  setGlobal(p_global, "dot", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_dot, 0));
+  setGlobal(p_global, "min", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_min, 0));
+  setGlobal(p_global, "max", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_max, 0));
+  setGlobal(p_global, "vadd", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_vadd, 0));
+  setGlobal(p_global, "vmul", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_vmul, 0));
+  setGlobal(p_global, "vscale", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_vscale, 0));
+  setGlobal(p_global, "cumsum", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_cumsum, 0));
+
+  /* maps */
+  setGlobal(p_global, "map_new", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_map_new, 0));
+  setGlobal(p_global, "map_get", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_map_get, 0));
+  setGlobal(p_global, "map_set", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_map_set, 0));
+  setGlobal(p_global, "map_has", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_map_has, 0));
+  setGlobal(p_global, "map_delete", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_map_delete, 0));
+  setGlobal(p_global, "map_keys", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_map_keys, 0));
+
+  /* sorting */
+  setGlobal(p_global, "sort", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_sort, 0));
+  setGlobal(p_global, "sort_desc", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_sort_desc, 0));
+  setGlobal(p_global, "sort_by", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_sort_by, 0));
+
+  /* parallel */
+  setGlobal(p_global, "pmap", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_pmap, 0));
+  setGlobal(p_global, "preduce", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_preduce, 0));
+
+  /* channels */
+  setGlobal(p_global, "spawn", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_spawn, 0));
+  setGlobal(p_global, "channel", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_channel, 0));
+  setGlobal(p_global, "send", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_send, 0));
+  setGlobal(p_global, "receive", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_receive, 0));
+
+  /* memoization */
+  setGlobal(p_global, "memo", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_memo, 0));
+  setGlobal(p_global, "memo_stats", Generic_new(TYPE_NATIVEFUNCTION, &StdLib_memo_stats, 0));
 
   return p_global;
 }
\ No newline at end of file
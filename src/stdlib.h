@@ -1,10 +1,18 @@
 #ifndef STDLIB_H
 #define STDLIB_H
+#include <stdbool.h>
 #include "generic.h"
 #include "scope.h"
 
 // prototypes
+void initOutput();
 Scope *newGlobal(int argc, char *argv[]);
 Generic *applyFunc(Generic *, Scope *, Generic *[], int, int);
+bool isFusedConsumer(Generic *);
+bool isFusedProducer(Generic *);
+Generic *applyFusedProducer(Generic *, Generic *[], int, int);
+bool isPureBuiltinName(char *);
+bool isPureBuiltin(char *, Generic *);
+Generic *foldPureBuiltin(char *, Generic *[], int);
 
 #endif
\ No newline at end of file
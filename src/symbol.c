@@ -0,0 +1,92 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "symbol.h"
+
+static SymbolTable symbolTable = {
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+  .symbols = NULL,
+  .capacity = 0,
+  .length = 0
+};
+
+// returns the fnv-1a hash of the length chars of name
+unsigned int hashName(char *name, int length) {
+  unsigned int res = 2166136261u;
+  for (int i = 0; i < length; i++) {
+    res ^= (unsigned char) name[i];
+    res *= 16777619u;
+  }
+
+  return res;
+}
+
+// returns the slot holding the symbol for the length chars of name, or the empty slot it belongs in
+// capacity is a power of two, so slots are found by masking
+char **findSymbol(char *name, int length, unsigned int hash) {
+  unsigned int mask = symbolTable.capacity - 1;
+  unsigned int i = hash & mask;
+
+  while (
+    symbolTable.symbols[i] != NULL
+    && !(strncmp(symbolTable.symbols[i], name, length) == 0 && symbolTable.symbols[i][length] == '\0')
+  ) i = (i + 1) & mask;
+
+  return &symbolTable.symbols[i];
+}
+
+// doubles the capacity of the table, moving every symbol into its new slot
+void growSymbolTable() {
+  char **oldSymbols = symbolTable.symbols;
+  int oldCapacity = symbolTable.capacity;
+
+  symbolTable.capacity = oldCapacity == 0 ? 256 : oldCapacity * 2;
+  symbolTable.symbols = (char **) calloc(symbolTable.capacity, sizeof(char *));
+
+  for (int i = 0; i < oldCapacity; i++) {
+    if (oldSymbols[i] == NULL) continue;
+    int length = strlen(oldSymbols[i]);
+    *findSymbol(oldSymbols[i], length, hashName(oldSymbols[i], length)) = oldSymbols[i];
+  }
+
+  free(oldSymbols);
+}
+
+// returns the symbol for the first length chars of name (which need not be null terminated)
+// the symbol is owned by the table, and must not be freed or modified
+char *Symbol_intern(char *name, int length) {
+  unsigned int hash = hashName(name, length);
+
+  pthread_mutex_lock(&symbolTable.lock);
+
+  if ((symbolTable.length + 1) * 2 > symbolTable.capacity) growSymbolTable();
+
+  char **p_slot = findSymbol(name, length, hash);
+
+  if (*p_slot == NULL) {
+    // case where name was not interned, copy it into the table
+    *p_slot = (char *) malloc(sizeof(char) * (length + 1));
+    memcpy(*p_slot, name, length);
+    (*p_slot)[length] = '\0';
+    symbolTable.length++;
+  }
+
+  char *res = *p_slot;
+  pthread_mutex_unlock(&symbolTable.lock);
+
+  return res;
+}
+
+// frees every symbol, once nothing holds them (ie. the ast and scopes have been freed)
+void SymbolTable_free() {
+  pthread_mutex_lock(&symbolTable.lock);
+
+  for (int i = 0; i < symbolTable.capacity; i++) free(symbolTable.symbols[i]);
+  free(symbolTable.symbols);
+
+  symbolTable.symbols = NULL;
+  symbolTable.capacity = 0;
+  symbolTable.length = 0;
+
+  pthread_mutex_unlock(&symbolTable.lock);
+}
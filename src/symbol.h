@@ -0,0 +1,20 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+#include <pthread.h>
+
+// table of interned identifier names (symbols)
+// each name is stored once, so two symbols are the same name if and only if they are the same pointer
+// symbols are looked up by open addressing, in a table which is kept at most half full
+// shared by every thread (ie. when parsing in chunks), so all access goes through lock
+typedef struct SymbolTable {
+  pthread_mutex_t lock;
+  char **symbols;
+  int capacity;
+  int length;
+} SymbolTable;
+
+// prototypes
+char *Symbol_intern(char *, int);
+void SymbolTable_free();
+
+#endif
@@ -0,0 +1,124 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+#include "timer.h"
+#include "generic.h"
+
+// every thread has its own timers, which only run while that thread waits (in wait, event, or run_timers)
+// so timer functions never run on a thread other than the one that set them, and no lock is needed
+__thread Timer *p_timers = NULL;
+__thread int nextTimerId = 1;
+
+// timers whose functions are running, innermost first (a timer function can wait, running other timers)
+__thread Timer *p_runningTimers = NULL;
+
+// gets the time in nanoseconds on the monotonic clock, from an arbitrary starting point
+long long Timer_now() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (long long) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// sleeps until the monotonic clock reaches time, without using the cpu
+void Timer_sleepUntil(long long time) {
+  struct timespec until = {.tv_sec = time / 1000000000, .tv_nsec = time % 1000000000};
+
+  // sleep again if a signal (ie. a resize) interrupts the sleep
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) == EINTR) {}
+}
+
+// inserts p_timer before the first timer due after it
+void insertTimer(Timer *p_timer) {
+  Timer **p_curr = &p_timers;
+  while (*p_curr != NULL && (*p_curr)->dueAt <= p_timer->dueAt) p_curr = &(*p_curr)->p_next;
+
+  p_timer->p_next = *p_curr;
+  *p_curr = p_timer;
+}
+
+// adds a timer, which applies a copy of p_func after delay, and every interval after that if interval is not -1
+// returns the id of the timer
+int Timer_add(Generic *p_func, long long delay, long long interval) {
+  Timer *p_timer = (Timer *) malloc(sizeof(Timer));
+  p_timer->id = nextTimerId++;
+  p_timer->dueAt = Timer_now() + delay;
+  p_timer->interval = interval;
+  p_timer->cancelled = false;
+
+  // referenced, so that applying the function does not free it
+  p_timer->p_func = Generic_copy(p_func);
+  p_timer->p_func->refCount++;
+
+  insertTimer(p_timer);
+  return p_timer->id;
+}
+
+void freeTimer(Timer *p_timer) {
+  Generic_free(p_timer->p_func);
+  free(p_timer);
+}
+
+// stops the timer with id from running again, returning false if there is no such timer
+bool Timer_cancel(int id) {
+  // running timers are marked, and freed once their function returns
+  for (Timer *p_curr = p_runningTimers; p_curr != NULL; p_curr = p_curr->p_next) {
+    if (p_curr->id == id && !p_curr->cancelled) {
+      p_curr->cancelled = true;
+      return true;
+    }
+  }
+
+  for (Timer **p_curr = &p_timers; *p_curr != NULL; p_curr = &(*p_curr)->p_next) {
+    if ((*p_curr)->id == id) {
+      Timer *p_timer = *p_curr;
+      *p_curr = p_timer->p_next;
+      freeTimer(p_timer);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// returns when the next timer is due, or -1 if there are no timers
+long long Timer_nextDue() {
+  return p_timers == NULL ? -1 : p_timers->dueAt;
+}
+
+// removes and returns the soonest timer if it is due at now, else returns NULL
+// the caller applies its function, then passes it to Timer_finish
+Timer *Timer_takeDue(long long now) {
+  if (p_timers == NULL || p_timers->dueAt > now) return NULL;
+
+  Timer *p_timer = p_timers;
+  p_timers = p_timer->p_next;
+
+  p_timer->p_next = p_runningTimers;
+  p_runningTimers = p_timer;
+  return p_timer;
+}
+
+// schedules the timer last taken by Timer_takeDue again if it is an interval (and was not cancelled), else frees it
+// intervals which fell behind skip the runs they missed, rather than running them all at once
+void Timer_finish(Timer *p_timer, long long now) {
+  p_runningTimers = p_timer->p_next;
+
+  if (p_timer->interval == -1 || p_timer->cancelled) {
+    freeTimer(p_timer);
+    return;
+  }
+
+  p_timer->dueAt += p_timer->interval;
+  if (p_timer->dueAt <= now) p_timer->dueAt = now + p_timer->interval;
+  insertTimer(p_timer);
+}
+
+// frees every timer on this thread, without running them
+void Timer_freeAll() {
+  while (p_timers != NULL) {
+    Timer *p_timer = p_timers;
+    p_timers = p_timer->p_next;
+    freeTimer(p_timer);
+  }
+}
@@ -0,0 +1,29 @@
+#ifndef TIMER_H
+#define TIMER_H
+#include <stdbool.h>
+#include "generic.h"
+
+// a function to apply once dueAt is reached, and again every interval after that (interval is -1 for timeouts)
+// times are in nanoseconds, on the monotonic clock (see Timer_now)
+// timers are kept in order of dueAt, soonest first
+// cancelled is set if the timer is cancelled while its function runs
+typedef struct Timer {
+  int id;
+  long long dueAt;
+  long long interval;
+  bool cancelled;
+  Generic *p_func;
+  struct Timer *p_next;
+} Timer;
+
+// prototypes
+long long Timer_now();
+void Timer_sleepUntil(long long);
+int Timer_add(Generic *, long long, long long);
+bool Timer_cancel(int);
+long long Timer_nextDue();
+Timer *Timer_takeDue(long long);
+void Timer_finish(Timer *, long long);
+void Timer_freeAll();
+
+#endif
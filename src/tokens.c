@@ -23,50 +23,49 @@ char* getTokenTypeString(enum TokenType type) {
   }
 }
 
+// creates an empty token list
+TokenList *TokenList_new() {
+  TokenList *res = (TokenList *) malloc(sizeof(TokenList));
+  res->length = 0;
+  res->capacity = 64;
+  res->tokens = (Token *) malloc(sizeof(Token) * res->capacity);
+  return res;
+}
+
 // print token list
-void Token_print(Token *p_head, int length) {
-  Token *p_curr = p_head;
-  int i = 0;
-  while (p_curr != NULL && i < length) {
+void TokenList_print(TokenList *p_list) {
+  for (int i = 0; i < p_list->length; i++) {
+    Token *p_curr = &p_list->tokens[i];
     if (p_curr->val == NULL) printf("%i| %s\n", p_curr->lineNumber, getTokenTypeString(p_curr->type));
-    else printf("%i| %s: %s\n", p_curr->lineNumber, getTokenTypeString(p_curr->type), p_curr->val);
-    
-    i++;
-    p_curr = p_curr->p_next;
+    else printf("%i| %s: %.*s\n", p_curr->lineNumber, getTokenTypeString(p_curr->type), p_curr->length, p_curr->val);
   }
 }
 
-// add token to list
-void Token_push(Token *p_head, char *val, enum TokenType type, int lineNumber) {
-  // loop to end of list
-  Token *p_curr = p_head;
-  while (p_curr->p_next != NULL) {
-    p_curr = p_curr->p_next;
+// add token to list, val is a slice of length chars (see Token)
+void TokenList_push(TokenList *p_list, char *val, int length, bool decoded, enum TokenType type, int lineNumber) {
+  // grow list when full
+  if (p_list->length == p_list->capacity) {
+    p_list->capacity *= 2;
+    p_list->tokens = (Token *) realloc(p_list->tokens, sizeof(Token) * p_list->capacity);
   }
 
-  // allocate memory for new token
-  Token *p_newToken = (Token *)(malloc(sizeof(Token)));
-
-  // add new node to end of list
-  p_curr->p_next = p_newToken;
-
   // write data
-  p_curr->p_next->val = val;
-  p_curr->p_next->type = type;
-  p_curr->p_next->p_next = NULL;
-  p_curr->p_next->lineNumber = lineNumber;
-}
-
-// frees all tokens, and their values
-void Token_free(Token *p_head) {
-  Token *p_curr = p_head;
-  Token *p_tmp = p_curr;
+  Token *p_newToken = &p_list->tokens[p_list->length];
+  p_newToken->val = val;
+  p_newToken->length = length;
+  p_newToken->decoded = decoded;
+  p_newToken->type = type;
+  p_newToken->lineNumber = lineNumber;
 
-  while (p_curr != NULL) {
-    p_tmp = p_curr;
-    p_curr = p_curr->p_next;
+  p_list->length++;
+}
 
-    free(p_tmp->val);
-    free(p_tmp);
+// frees all tokens, and their decoded values
+void TokenList_free(TokenList *p_list) {
+  for (int i = 0; i < p_list->length; i++) {
+    if (p_list->tokens[i].decoded) free(p_list->tokens[i].val);
   }
+
+  free(p_list->tokens);
+  free(p_list);
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #ifndef TOKENS_H
 #define TOKENS_H
+#include <stdbool.h>
 
 enum TokenType {
   TOK_ASSIGNMENT, 
@@ -19,18 +20,28 @@ enum TokenType {
 };
 
 // token
-// linked list element containing pointer to next token, type of token, and value
+// val is a slice of length chars, pointing into the source code (not null terminated)
+// strings containing escape codes are decoded into their own memory instead, which the token owns (decoded is set)
 typedef struct Token {
   char *val;
+  int length;
+  bool decoded;
   enum TokenType type;
-  struct Token *p_next;
   int lineNumber;
 } Token;
 
+// tokens of a program, stored contiguously in order
+typedef struct TokenList {
+  Token *tokens;
+  int length;
+  int capacity;
+} TokenList;
+
 // prototypes
 char* getTokenTypeString(enum TokenType);
-void Token_print(Token *, int);
-void Token_push(Token *, char *, enum TokenType, int);
-void Token_free(Token *);
+TokenList *TokenList_new();
+void TokenList_print(TokenList *);
+void TokenList_push(TokenList *, char *, int, bool, enum TokenType, int);
+void TokenList_free(TokenList *);
 
 #endif
\ No newline at end of file
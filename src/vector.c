@@ -0,0 +1,589 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "vector.h"
+
+// kernels use the widest instruction set enabled at compile time (ie. with -march=native)
+// SSE2 is always available on x86-64, SSE4.1 and AVX/AVX2 must be enabled explicitly
+// every kernel falls back to a scalar loop for the tail, and for other architectures
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// ints are accumulated as unsigned, so that overflow wraps like the vector instructions do
+
+// returns the sum of all length items in vals
+int Vector_sumInts(int *vals, int length) {
+  unsigned int res = 0;
+  int i = 0;
+
+#if defined(__AVX2__)
+  __m256i acc = _mm256_setzero_si256();
+  for (; i + 8 <= length; i += 8) {
+    acc = _mm256_add_epi32(acc, _mm256_loadu_si256((__m256i *) &vals[i]));
+  }
+
+  int lanes[8];
+  _mm256_storeu_si256((__m256i *) lanes, acc);
+  for (int j = 0; j < 8; j++) res += lanes[j];
+#elif defined(__SSE2__)
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 4 <= length; i += 4) {
+    acc = _mm_add_epi32(acc, _mm_loadu_si128((__m128i *) &vals[i]));
+  }
+
+  int lanes[4];
+  _mm_storeu_si128((__m128i *) lanes, acc);
+  for (int j = 0; j < 4; j++) res += lanes[j];
+#endif
+
+  for (; i < length; i++) res += vals[i];
+  return (int) res;
+}
+
+double Vector_sumFloats(double *vals, int length) {
+  double res = 0;
+  int i = 0;
+
+#if defined(__AVX__)
+  __m256d acc = _mm256_setzero_pd();
+  for (; i + 4 <= length; i += 4) acc = _mm256_add_pd(acc, _mm256_loadu_pd(&vals[i]));
+
+  double lanes[4];
+  _mm256_storeu_pd(lanes, acc);
+  res = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(__SSE2__)
+  __m128d acc = _mm_setzero_pd();
+  for (; i + 2 <= length; i += 2) acc = _mm_add_pd(acc, _mm_loadu_pd(&vals[i]));
+
+  double lanes[2];
+  _mm_storeu_pd(lanes, acc);
+  res = lanes[0] + lanes[1];
+#endif
+
+  for (; i < length; i++) res += vals[i];
+  return res;
+}
+
+// returns the product of all length items in vals
+int Vector_productInts(int *vals, int length) {
+  unsigned int res = 1;
+  int i = 0;
+
+#if defined(__AVX2__)
+  __m256i acc = _mm256_set1_epi32(1);
+  for (; i + 8 <= length; i += 8) {
+    acc = _mm256_mullo_epi32(acc, _mm256_loadu_si256((__m256i *) &vals[i]));
+  }
+
+  int lanes[8];
+  _mm256_storeu_si256((__m256i *) lanes, acc);
+  for (int j = 0; j < 8; j++) res *= lanes[j];
+#elif defined(__SSE4_1__)
+  __m128i acc = _mm_set1_epi32(1);
+  for (; i + 4 <= length; i += 4) {
+    acc = _mm_mullo_epi32(acc, _mm_loadu_si128((__m128i *) &vals[i]));
+  }
+
+  int lanes[4];
+  _mm_storeu_si128((__m128i *) lanes, acc);
+  for (int j = 0; j < 4; j++) res *= lanes[j];
+#endif
+
+  for (; i < length; i++) res *= vals[i];
+  return (int) res;
+}
+
+double Vector_productFloats(double *vals, int length) {
+  double res = 1;
+  int i = 0;
+
+#if defined(__AVX__)
+  __m256d acc = _mm256_set1_pd(1);
+  for (; i + 4 <= length; i += 4) acc = _mm256_mul_pd(acc, _mm256_loadu_pd(&vals[i]));
+
+  double lanes[4];
+  _mm256_storeu_pd(lanes, acc);
+  res = (lanes[0] * lanes[1]) * (lanes[2] * lanes[3]);
+#elif defined(__SSE2__)
+  __m128d acc = _mm_set1_pd(1);
+  for (; i + 2 <= length; i += 2) acc = _mm_mul_pd(acc, _mm_loadu_pd(&vals[i]));
+
+  double lanes[2];
+  _mm_storeu_pd(lanes, acc);
+  res = lanes[0] * lanes[1];
+#endif
+
+  for (; i < length; i++) res *= vals[i];
+  return res;
+}
+
+// returns the sum of a[i] * b[i], for all length items
+int Vector_dotInts(int *a, int *b, int length) {
+  unsigned int res = 0;
+  int i = 0;
+
+#if defined(__AVX2__)
+  __m256i acc = _mm256_setzero_si256();
+  for (; i + 8 <= length; i += 8) {
+    __m256i prod = _mm256_mullo_epi32(
+      _mm256_loadu_si256((__m256i *) &a[i]),
+      _mm256_loadu_si256((__m256i *) &b[i])
+    );
+    acc = _mm256_add_epi32(acc, prod);
+  }
+
+  int lanes[8];
+  _mm256_storeu_si256((__m256i *) lanes, acc);
+  for (int j = 0; j < 8; j++) res += lanes[j];
+#elif defined(__SSE4_1__)
+  __m128i acc = _mm_setzero_si128();
+  for (; i + 4 <= length; i += 4) {
+    __m128i prod = _mm_mullo_epi32(
+      _mm_loadu_si128((__m128i *) &a[i]),
+      _mm_loadu_si128((__m128i *) &b[i])
+    );
+    acc = _mm_add_epi32(acc, prod);
+  }
+
+  int lanes[4];
+  _mm_storeu_si128((__m128i *) lanes, acc);
+  for (int j = 0; j < 4; j++) res += lanes[j];
+#endif
+
+  for (; i < length; i++) res += (unsigned int) a[i] * (unsigned int) b[i];
+  return (int) res;
+}
+
+double Vector_dotFloats(double *a, double *b, int length) {
+  double res = 0;
+  int i = 0;
+
+#if defined(__AVX__)
+  __m256d acc = _mm256_setzero_pd();
+  for (; i + 4 <= length; i += 4) {
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(&a[i]), _mm256_loadu_pd(&b[i])));
+  }
+
+  double lanes[4];
+  _mm256_storeu_pd(lanes, acc);
+  res = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(__SSE2__)
+  __m128d acc = _mm_setzero_pd();
+  for (; i + 2 <= length; i += 2) {
+    acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(&a[i]), _mm_loadu_pd(&b[i])));
+  }
+
+  double lanes[2];
+  _mm_storeu_pd(lanes, acc);
+  res = lanes[0] + lanes[1];
+#endif
+
+  for (; i < length; i++) res += a[i] * b[i];
+  return res;
+}
+
+// returns the smallest of length items in vals, length must be at least 1
+int Vector_minInts(int *vals, int length) {
+  int res = vals[0];
+  int i = 0;
+
+#if defined(__AVX2__)
+  if (length >= 8) {
+    __m256i acc = _mm256_loadu_si256((__m256i *) vals);
+    for (i = 8; i + 8 <= length; i += 8) {
+      acc = _mm256_min_epi32(acc, _mm256_loadu_si256((__m256i *) &vals[i]));
+    }
+
+    int lanes[8];
+    _mm256_storeu_si256((__m256i *) lanes, acc);
+    for (int j = 0; j < 8; j++) if (lanes[j] < res) res = lanes[j];
+  }
+#elif defined(__SSE4_1__)
+  if (length >= 4) {
+    __m128i acc = _mm_loadu_si128((__m128i *) vals);
+    for (i = 4; i + 4 <= length; i += 4) {
+      acc = _mm_min_epi32(acc, _mm_loadu_si128((__m128i *) &vals[i]));
+    }
+
+    int lanes[4];
+    _mm_storeu_si128((__m128i *) lanes, acc);
+    for (int j = 0; j < 4; j++) if (lanes[j] < res) res = lanes[j];
+  }
+#endif
+
+  for (; i < length; i++) if (vals[i] < res) res = vals[i];
+  return res;
+}
+
+double Vector_minFloats(double *vals, int length) {
+  double res = vals[0];
+  int i = 0;
+
+#if defined(__AVX__)
+  if (length >= 4) {
+    __m256d acc = _mm256_loadu_pd(vals);
+    for (i = 4; i + 4 <= length; i += 4) acc = _mm256_min_pd(acc, _mm256_loadu_pd(&vals[i]));
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    for (int j = 0; j < 4; j++) if (lanes[j] < res) res = lanes[j];
+  }
+#elif defined(__SSE2__)
+  if (length >= 2) {
+    __m128d acc = _mm_loadu_pd(vals);
+    for (i = 2; i + 2 <= length; i += 2) acc = _mm_min_pd(acc, _mm_loadu_pd(&vals[i]));
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+    for (int j = 0; j < 2; j++) if (lanes[j] < res) res = lanes[j];
+  }
+#endif
+
+  for (; i < length; i++) if (vals[i] < res) res = vals[i];
+  return res;
+}
+
+// returns the largest of length items in vals, length must be at least 1
+int Vector_maxInts(int *vals, int length) {
+  int res = vals[0];
+  int i = 0;
+
+#if defined(__AVX2__)
+  if (length >= 8) {
+    __m256i acc = _mm256_loadu_si256((__m256i *) vals);
+    for (i = 8; i + 8 <= length; i += 8) {
+      acc = _mm256_max_epi32(acc, _mm256_loadu_si256((__m256i *) &vals[i]));
+    }
+
+    int lanes[8];
+    _mm256_storeu_si256((__m256i *) lanes, acc);
+    for (int j = 0; j < 8; j++) if (lanes[j] > res) res = lanes[j];
+  }
+#elif defined(__SSE4_1__)
+  if (length >= 4) {
+    __m128i acc = _mm_loadu_si128((__m128i *) vals);
+    for (i = 4; i + 4 <= length; i += 4) {
+      acc = _mm_max_epi32(acc, _mm_loadu_si128((__m128i *) &vals[i]));
+    }
+
+    int lanes[4];
+    _mm_storeu_si128((__m128i *) lanes, acc);
+    for (int j = 0; j < 4; j++) if (lanes[j] > res) res = lanes[j];
+  }
+#endif
+
+  for (; i < length; i++) if (vals[i] > res) res = vals[i];
+  return res;
+}
+
+double Vector_maxFloats(double *vals, int length) {
+  double res = vals[0];
+  int i = 0;
+
+#if defined(__AVX__)
+  if (length >= 4) {
+    __m256d acc = _mm256_loadu_pd(vals);
+    for (i = 4; i + 4 <= length; i += 4) acc = _mm256_max_pd(acc, _mm256_loadu_pd(&vals[i]));
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    for (int j = 0; j < 4; j++) if (lanes[j] > res) res = lanes[j];
+  }
+#elif defined(__SSE2__)
+  if (length >= 2) {
+    __m128d acc = _mm_loadu_pd(vals);
+    for (i = 2; i + 2 <= length; i += 2) acc = _mm_max_pd(acc, _mm_loadu_pd(&vals[i]));
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+    for (int j = 0; j < 2; j++) if (lanes[j] > res) res = lanes[j];
+  }
+#endif
+
+  for (; i < length; i++) if (vals[i] > res) res = vals[i];
+  return res;
+}
+
+// writes a[i] + b[i] to res[i], for all length items
+void Vector_addInts(int *res, int *a, int *b, int length) {
+  int i = 0;
+
+#if defined(__AVX2__)
+  for (; i + 8 <= length; i += 8) {
+    __m256i sum = _mm256_add_epi32(_mm256_loadu_si256((__m256i *) &a[i]), _mm256_loadu_si256((__m256i *) &b[i]));
+    _mm256_storeu_si256((__m256i *) &res[i], sum);
+  }
+#elif defined(__SSE2__)
+  for (; i + 4 <= length; i += 4) {
+    __m128i sum = _mm_add_epi32(_mm_loadu_si128((__m128i *) &a[i]), _mm_loadu_si128((__m128i *) &b[i]));
+    _mm_storeu_si128((__m128i *) &res[i], sum);
+  }
+#endif
+
+  for (; i < length; i++) res[i] = (int) ((unsigned int) a[i] + (unsigned int) b[i]);
+}
+
+void Vector_addFloats(double *res, double *a, double *b, int length) {
+  int i = 0;
+
+#if defined(__AVX__)
+  for (; i + 4 <= length; i += 4) {
+    _mm256_storeu_pd(&res[i], _mm256_add_pd(_mm256_loadu_pd(&a[i]), _mm256_loadu_pd(&b[i])));
+  }
+#elif defined(__SSE2__)
+  for (; i + 2 <= length; i += 2) {
+    _mm_storeu_pd(&res[i], _mm_add_pd(_mm_loadu_pd(&a[i]), _mm_loadu_pd(&b[i])));
+  }
+#endif
+
+  for (; i < length; i++) res[i] = a[i] + b[i];
+}
+
+// writes a[i] * b[i] to res[i], for all length items
+void Vector_mulInts(int *res, int *a, int *b, int length) {
+  int i = 0;
+
+#if defined(__AVX2__)
+  for (; i + 8 <= length; i += 8) {
+    __m256i prod = _mm256_mullo_epi32(_mm256_loadu_si256((__m256i *) &a[i]), _mm256_loadu_si256((__m256i *) &b[i]));
+    _mm256_storeu_si256((__m256i *) &res[i], prod);
+  }
+#elif defined(__SSE4_1__)
+  for (; i + 4 <= length; i += 4) {
+    __m128i prod = _mm_mullo_epi32(_mm_loadu_si128((__m128i *) &a[i]), _mm_loadu_si128((__m128i *) &b[i]));
+    _mm_storeu_si128((__m128i *) &res[i], prod);
+  }
+#endif
+
+  for (; i < length; i++) res[i] = (int) ((unsigned int) a[i] * (unsigned int) b[i]);
+}
+
+void Vector_mulFloats(double *res, double *a, double *b, int length) {
+  int i = 0;
+
+#if defined(__AVX__)
+  for (; i + 4 <= length; i += 4) {
+    _mm256_storeu_pd(&res[i], _mm256_mul_pd(_mm256_loadu_pd(&a[i]), _mm256_loadu_pd(&b[i])));
+  }
+#elif defined(__SSE2__)
+  for (; i + 2 <= length; i += 2) {
+    _mm_storeu_pd(&res[i], _mm_mul_pd(_mm_loadu_pd(&a[i]), _mm_loadu_pd(&b[i])));
+  }
+#endif
+
+  for (; i < length; i++) res[i] = a[i] * b[i];
+}
+
+// writes vals[i] * k to res[i], for all length items
+void Vector_scaleInts(int *res, int *vals, int k, int length) {
+  int i = 0;
+
+#if defined(__AVX2__)
+  __m256i factor = _mm256_set1_epi32(k);
+  for (; i + 8 <= length; i += 8) {
+    _mm256_storeu_si256((__m256i *) &res[i], _mm256_mullo_epi32(_mm256_loadu_si256((__m256i *) &vals[i]), factor));
+  }
+#elif defined(__SSE4_1__)
+  __m128i factor = _mm_set1_epi32(k);
+  for (; i + 4 <= length; i += 4) {
+    _mm_storeu_si128((__m128i *) &res[i], _mm_mullo_epi32(_mm_loadu_si128((__m128i *) &vals[i]), factor));
+  }
+#endif
+
+  for (; i < length; i++) res[i] = (int) ((unsigned int) vals[i] * (unsigned int) k);
+}
+
+void Vector_scaleFloats(double *res, double *vals, double k, int length) {
+  int i = 0;
+
+#if defined(__AVX__)
+  __m256d factor = _mm256_set1_pd(k);
+  for (; i + 4 <= length; i += 4) {
+    _mm256_storeu_pd(&res[i], _mm256_mul_pd(_mm256_loadu_pd(&vals[i]), factor));
+  }
+#elif defined(__SSE2__)
+  __m128d factor = _mm_set1_pd(k);
+  for (; i + 2 <= length; i += 2) {
+    _mm_storeu_pd(&res[i], _mm_mul_pd(_mm_loadu_pd(&vals[i]), factor));
+  }
+#endif
+
+  for (; i < length; i++) res[i] = vals[i] * k;
+}
+
+// writes the running total of vals to res
+// each item depends on the last, so this stays scalar
+void Vector_cumsumInts(int *res, int *vals, int length) {
+  unsigned int acc = 0;
+  for (int i = 0; i < length; i++) {
+    acc += vals[i];
+    res[i] = (int) acc;
+  }
+}
+
+void Vector_cumsumFloats(double *res, double *vals, int length) {
+  double acc = 0;
+  for (int i = 0; i < length; i++) {
+    acc += vals[i];
+    res[i] = acc;
+  }
+}
+
+// scanning kernels, used by the lexer (see lex.c)
+// each returns the index of the first char in code[start, end) of some class, or end if there is none
+// blocks of 32 (AVX2) or 16 (SSE2) chars are classified at once, and never read past end
+
+// returns true if c is whitespace (\t, \n, \v, \f, \r or space)
+bool isWhitespace(char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// returns true if c can end an identifier (see Vector_findIdentifierEnd)
+bool isIdentifierEnd(char c) {
+  return isWhitespace(c) || strchr("{}()\"=-</", c) != NULL;
+}
+
+#if defined(__AVX2__)
+// returns a mask of the chars in block which are whitespace
+// \t to \r are contiguous, so they are the chars for which c - \t is at most 4 (as an unsigned byte)
+__m256i whitespaceMask256(__m256i block) {
+  __m256i offset = _mm256_sub_epi8(block, _mm256_set1_epi8('\t'));
+  __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8(4)), offset);
+  return _mm256_or_si256(control, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(' ')));
+}
+
+// returns a mask of the chars in block which are equal to c
+__m256i charMask256(__m256i block, char c) {
+  return _mm256_cmpeq_epi8(block, _mm256_set1_epi8(c));
+}
+#elif defined(__SSE2__)
+// returns a mask of the chars in block which are whitespace
+// \t to \r are contiguous, so they are the chars for which c - \t is at most 4 (as an unsigned byte)
+__m128i whitespaceMask128(__m128i block) {
+  __m128i offset = _mm_sub_epi8(block, _mm_set1_epi8('\t'));
+  __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8(4)), offset);
+  return _mm_or_si128(control, _mm_cmpeq_epi8(block, _mm_set1_epi8(' ')));
+}
+
+// returns a mask of the chars in block which are equal to c
+__m128i charMask128(__m128i block, char c) {
+  return _mm_cmpeq_epi8(block, _mm_set1_epi8(c));
+}
+#endif
+
+// finds the first char which can end an identifier
+// that is, whitespace, one of {}()"=, a null char, or one of -</ (which only end an identifier as part of ->, <- or //)
+int Vector_findIdentifierEnd(char *code, int start, int end) {
+  int i = start;
+
+#if defined(__AVX2__)
+  for (; i + 32 <= end; i += 32) {
+    __m256i block = _mm256_loadu_si256((__m256i *) &code[i]);
+    __m256i mask = _mm256_or_si256(whitespaceMask256(block), charMask256(block, '\0'));
+    mask = _mm256_or_si256(mask, _mm256_or_si256(charMask256(block, '{'), charMask256(block, '}')));
+    mask = _mm256_or_si256(mask, _mm256_or_si256(charMask256(block, '('), charMask256(block, ')')));
+    mask = _mm256_or_si256(mask, _mm256_or_si256(charMask256(block, '"'), charMask256(block, '=')));
+    mask = _mm256_or_si256(mask, _mm256_or_si256(charMask256(block, '-'), charMask256(block, '<')));
+    mask = _mm256_or_si256(mask, charMask256(block, '/'));
+
+    unsigned int bits = (unsigned int) _mm256_movemask_epi8(mask);
+    if (bits != 0) return i + __builtin_ctz(bits);
+  }
+#elif defined(__SSE2__)
+  for (; i + 16 <= end; i += 16) {
+    __m128i block = _mm_loadu_si128((__m128i *) &code[i]);
+    __m128i mask = _mm_or_si128(whitespaceMask128(block), charMask128(block, '\0'));
+    mask = _mm_or_si128(mask, _mm_or_si128(charMask128(block, '{'), charMask128(block, '}')));
+    mask = _mm_or_si128(mask, _mm_or_si128(charMask128(block, '('), charMask128(block, ')')));
+    mask = _mm_or_si128(mask, _mm_or_si128(charMask128(block, '"'), charMask128(block, '=')));
+    mask = _mm_or_si128(mask, _mm_or_si128(charMask128(block, '-'), charMask128(block, '<')));
+    mask = _mm_or_si128(mask, charMask128(block, '/'));
+
+    unsigned int bits = (unsigned int) _mm_movemask_epi8(mask);
+    if (bits != 0) return i + __builtin_ctz(bits);
+  }
+#endif
+
+  for (; i < end; i++) {
+    if (code[i] == '\0' || isIdentifierEnd(code[i])) return i;
+  }
+
+  return end;
+}
+
+// finds the first char which ends the contents of a string, or needs checking
+// that is, a quote, a backslash, a newline or a null char
+int Vector_findStringEnd(char *code, int start, int end) {
+  int i = start;
+
+#if defined(__AVX2__)
+  for (; i + 32 <= end; i += 32) {
+    __m256i block = _mm256_loadu_si256((__m256i *) &code[i]);
+    __m256i mask = _mm256_or_si256(charMask256(block, '"'), charMask256(block, '\\'));
+    mask = _mm256_or_si256(mask, _mm256_or_si256(charMask256(block, '\n'), charMask256(block, '\0')));
+
+    unsigned int bits = (unsigned int) _mm256_movemask_epi8(mask);
+    if (bits != 0) return i + __builtin_ctz(bits);
+  }
+#elif defined(__SSE2__)
+  for (; i + 16 <= end; i += 16) {
+    __m128i block = _mm_loadu_si128((__m128i *) &code[i]);
+    __m128i mask = _mm_or_si128(charMask128(block, '"'), charMask128(block, '\\'));
+    mask = _mm_or_si128(mask, _mm_or_si128(charMask128(block, '\n'), charMask128(block, '\0')));
+
+    unsigned int bits = (unsigned int) _mm_movemask_epi8(mask);
+    if (bits != 0) return i + __builtin_ctz(bits);
+  }
+#endif
+
+  for (; i < end; i++) {
+    if (code[i] == '"' || code[i] == '\\' || code[i] == '\n' || code[i] == '\0') return i;
+  }
+
+  return end;
+}
+
+// finds the first char which is not whitespace
+// adds the number of newlines skipped over to *p_newlines
+int Vector_skipWhitespace(char *code, int start, int end, int *p_newlines) {
+  int i = start;
+
+#if defined(__AVX2__)
+  for (; i + 32 <= end; i += 32) {
+    __m256i block = _mm256_loadu_si256((__m256i *) &code[i]);
+    unsigned int other = ~(unsigned int) _mm256_movemask_epi8(whitespaceMask256(block));
+    unsigned int newlines = (unsigned int) _mm256_movemask_epi8(charMask256(block, '\n'));
+
+    if (other != 0) {
+      // only count newlines before the first other char
+      int offset = __builtin_ctz(other);
+      *p_newlines += __builtin_popcount(newlines & ((1u << offset) - 1));
+      return i + offset;
+    }
+
+    *p_newlines += __builtin_popcount(newlines);
+  }
+#elif defined(__SSE2__)
+  for (; i + 16 <= end; i += 16) {
+    __m128i block = _mm_loadu_si128((__m128i *) &code[i]);
+    unsigned int other = ~(unsigned int) _mm_movemask_epi8(whitespaceMask128(block)) & 0xFFFF;
+    unsigned int newlines = (unsigned int) _mm_movemask_epi8(charMask128(block, '\n'));
+
+    if (other != 0) {
+      // only count newlines before the first other char
+      int offset = __builtin_ctz(other);
+      *p_newlines += __builtin_popcount(newlines & ((1u << offset) - 1));
+      return i + offset;
+    }
+
+    *p_newlines += __builtin_popcount(newlines);
+  }
+#endif
+
+  for (; i < end && isWhitespace(code[i]); i++) {
+    if (code[i] == '\n') (*p_newlines)++;
+  }
+
+  return i;
+}
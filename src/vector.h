@@ -0,0 +1,31 @@
+#ifndef VECTOR_H
+#define VECTOR_H
+
+// prototypes
+// kernels over packed numeric arrays, used by the vector functions in the standard library
+// ints wrap on overflow
+int Vector_sumInts(int *, int);
+double Vector_sumFloats(double *, int);
+int Vector_productInts(int *, int);
+double Vector_productFloats(double *, int);
+int Vector_dotInts(int *, int *, int);
+double Vector_dotFloats(double *, double *, int);
+int Vector_minInts(int *, int);
+double Vector_minFloats(double *, int);
+int Vector_maxInts(int *, int);
+double Vector_maxFloats(double *, int);
+void Vector_addInts(int *, int *, int *, int);
+void Vector_addFloats(double *, double *, double *, int);
+void Vector_mulInts(int *, int *, int *, int);
+void Vector_mulFloats(double *, double *, double *, int);
+void Vector_scaleInts(int *, int *, int, int);
+void Vector_scaleFloats(double *, double *, double, int);
+void Vector_cumsumInts(int *, int *, int);
+void Vector_cumsumFloats(double *, double *, int);
+
+// kernels scanning source code, used by the lexer
+int Vector_findIdentifierEnd(char *, int, int);
+int Vector_findStringEnd(char *, int, int);
+int Vector_skipWhitespace(char *, int, int, int *);
+
+#endif